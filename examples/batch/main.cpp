@@ -0,0 +1,46 @@
+#ifdef CLICMD_HEADER_ONLY
+#include "cli-cmd.hpp"
+#else
+#include "cli-cmd.h"
+#endif
+#include <chrono>
+#include <iostream>
+
+// Benchmark of Application::parseBatch: validates generated script and reports lines per second
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    cli::Application app("batch", 1, 1, 1);
+    app.addCommand("clone")
+        .addArg("repository", "url")
+        .addArgs("directory", "auto-path", 0, 1)
+        .addFlag("--verbose", "-v", "be more verbose")
+        .addParameter("--depth", "", "Create a shallow clone", "integer")
+        .handler([](cli::Actual*) { return 0; });
+    app.addCommand("add")
+        .addArgs("pathspec", "auto-path", 1)
+        .addFlag("--force", "-f", "allow adding ignored files")
+        .handler([](cli::Actual*) { return 0; });
+
+    std::vector<std::string> script;
+    script.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        switch (i % 4) {
+            case 0: script.push_back("clone https://example.com/repo" + std::to_string(i) + ".git dir"); break;
+            case 1: script.push_back("clone -v --depth " + std::to_string(i) + " https://example.com/r.git"); break;
+            case 2: script.push_back("add -f src/a.cpp src/b.cpp 'docs/read me.md'"); break;
+            default: script.push_back(i % 1000 == 3 ? "clone --depth many x" : "add include/a.h"); break;
+        }
+    std::vector<std::string_view> lines(script.begin(), script.end());
+
+    for (unsigned jobs : {1u, 0u}) {
+        auto start = std::chrono::steady_clock::now();
+        auto results = app.parseBatch(lines, jobs);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        size_t errors = 0;
+        for (const auto& result : results)
+            errors += result.errNumber != 0;
+        std::cout << (jobs ? "1 thread: " : "all threads: ") << static_cast<size_t>(count / elapsed.count())
+                  << " lines/s, " << errors << " errors" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+#ifdef CLICMD_HEADER_ONLY
+#include "cli-cmd.hpp"
+#else
+#include "cli-cmd.h"
+#endif
+#include <iostream>
+#include "schema.h" // generated by clicmd-gen from schema.json
+
+int clone_(const cli::Actual* actual)
+{
+    std::cout << "clone " << actual->arguments[0].value << " as " << *actual->getValue("--origin") << std::endl;
+    return 0;
+}
+
+int status_(const cli::Actual* actual)
+{
+    std::cout << "status" << (actual->containsFlag("--short") ? " (short)" : "") << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // pre-rendered help doesn't need Application at all
+    if (argc == 1) {
+        std::cout << likegen::helpText;
+        return 0;
+    }
+    if (argc == 3 && std::string(argv[1]) == "help") {
+        if (auto text = likegen::commandHelp(argv[2])) {
+            std::cout << text;
+            return 0;
+        }
+    }
+    cli::Application app("generated", 1, 1, 1);
+    likegen::addCommands(app);
+    return app.run(argc, argv);
+}
@@ -28,22 +28,31 @@ void addOptions(cli::Command *cmd)
     cmd->addFlag("-print-sysroot", "", "Display the target libraries directory.");
     cmd->addFlag("-print-sysroot-headers-suffix", "", "Display the sysroot suffix used to find headers.");
 
-    cmd->addParameter("-Wa", "", "Pass comma-separated <options> on to the assembler.", "string");
-    cmd->addParameter("-Wp", "", "Pass comma-separated <options> on to the preprocessor.", "string");
-    cmd->addParameter("-Wl", "", "Pass comma-separated <options> on to the linker.", "string");
-    cmd->addParameter("-Xassembler", "", "Pass <arg> on to the assembler.", "string");
-    cmd->addParameter("-Xpreprocessor", "", "Pass <arg> on to the preprocessor.", "string");
-    cmd->addParameter("-Xlinker", "", "Pass <arg> on to the linker.", "string");
+    cmd->addPrefixParameter("-Wa,", "Pass comma-separated <options> on to the assembler.", "string", true);
+    cmd->addPrefixParameter("-Wp,", "Pass comma-separated <options> on to the preprocessor.", "string", true);
+    cmd->addPrefixParameter("-Wl,", "Pass comma-separated <options> on to the linker.", "string", true);
+    cmd->addPrefixParameter("-W", "Enable or disable warning.", "string", true);
+    cmd->addListParameter("-Xassembler", "", "Pass <arg> on to the assembler.", "string");
+    cmd->addListParameter("-Xpreprocessor", "", "Pass <arg> on to the preprocessor.", "string");
+    cmd->addListParameter("-Xlinker", "", "Pass <arg> on to the linker.", "string");
     cmd->addFlag("-save-temps", "", "Do not delete intermediate files.");
     cmd->addFlag("-no-canonical-prefixes", "", "Do not canonicalize paths when building relative\n"
                                                "prefixes to other gcc components.");
     cmd->addFlag("-pipe", "", "Use pipes rather than intermediate files.");
     cmd->addFlag("-time", "", "Time the execution of each subprocess.");
     cmd->addParameter("-specs", "", "Override built-in specs with the contents of <file>.", "path");
-    cmd->addParameter("-std", "", "Assume that the input sources are for <standard>.", "string");
+    cmd->addPrefixParameter("-std=", "Assume that the input sources are for <standard>.", "string");
     cmd->addParameter("--sysroot", "", "Use <directory> as the root directory for headers\n"
                                        "and libraries.", "path");
-    cmd->addParameter("-B", "", "Add <directory> to the compiler's search paths.", "path");
+    cmd->addPrefixParameter("-B", "Add <directory> to the compiler's search paths.", "path", true, true);
+    cmd->addPrefixParameter("-I", "Add <directory> to the include search path.", "path", true, true);
+    cmd->addPrefixParameter("-L", "Add <directory> to the library search path.", "path", true, true);
+    cmd->addPrefixParameter("-l", "Link with <library>.", "string", true, true);
+    cmd->addPrefixParameter("-D", "Define <macro>[=<value>].", "string", true, true);
+    cmd->addPrefixParameter("-U", "Undefine <macro>.", "string", true, true);
+    cmd->addPrefixParameter("-O", "Set optimization <level>.", "string");
+    cmd->addPrefixParameter("-f", "Enable code generation <feature>.", "string", true);
+    cmd->addPrefixParameter("-m", "Set machine <option>.", "string", true);
     cmd->addFlag("-v", "", "Display the programs invoked by the compiler.");
     cmd->addFlag("-E", "", "Preprocess only; do not compile, assemble or link.");
     cmd->addFlag("-S", "", "Compile only; do not assemble or link.");
@@ -38,10 +38,6 @@ int main(int argc, char** argv) {
     addDeveloperFacing(app);
     addExternalCommands(app);
     addCommonCommands(app);
-    auto cloneCmd = app.getCommand("clone");
-    cloneCmd->handler(clone_);
-    cloneCmd->addFlag("--verbose", "-v", "be more verbose");
-    cloneCmd->addFlag("--quiet", "-q", "be more quiet");
     app.run(argc, argv);
     return 0;
 }
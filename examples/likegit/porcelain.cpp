@@ -4,6 +4,8 @@
 #include "cli-cmd.h"
 #endif
 
+int clone_(const cli::Actual* actual);
+
 void addCommonCommands(cli::Application &app)
 {
     app.addHelpCategory("start a working area (see also: git help tutorial)")
@@ -31,8 +33,12 @@ void addPorcelainCommands(cli::Application &app)
     category->addCommand("cherry-pick").desc("Apply the changes introduced by some existing commits");
     category->addCommand("citool").desc("Graphical alternative to git-commit");
     category->addCommand("clean").desc("Remove untracked files from the working tree");
-    category->addCommand("clone").desc("Clone a repository into a new directory")
-        .addArg("repository","auto-path");
+    category->addCommand("clone", "Clone a repository into a new directory", [](cli::Command& cmd) {
+        cmd.addArg("repository","auto-path")
+            .addFlag("--verbose", "-v", "be more verbose")
+            .addFlag("--quiet", "-q", "be more quiet")
+            .handler(clone_);
+    });
     category->addCommand("commit").desc("Record changes to the repository");
     category->addCommand("describe").desc("Give an object a human readable name based on an available ref");
     category->addCommand("diff").desc("Show changes between commits, commit and working tree, etc");
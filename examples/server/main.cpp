@@ -0,0 +1,54 @@
+#ifdef CLICMD_HEADER_ONLY
+#include "cli-cmd.hpp"
+#else
+#include "cli-cmd.h"
+#endif
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Resident server and its client shim in one binary:
+//   server --serve &            builds the application once and listens on $SERVER_SOCKET
+//   server hello world          forwards argv, environment and directory to it, or runs locally without server
+static std::string socketPath() {
+    const char* path = std::getenv("SERVER_SOCKET");
+    return path ? path : "/tmp/clicmd-server.sock";
+}
+
+static void define(cli::Application& app) {
+    // stands for expensive initialization of handlers
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    app.addCommand("hello")
+        .addArgs("names", "string", 0)
+        .handler([](cli::Actual* actual) {
+            const auto* request = cli::currentRequest();
+            const char* user = request ? request->getenv("USER") : std::getenv("USER");
+            std::cout << "hello from " << (user ? user : "nobody") << " to";
+            for (const auto& name : actual->arguments)
+                std::cout << ' ' << name.value;
+            std::cout << std::endl;
+            return 0;
+        });
+    app.addCommand("stop").handler([&app](cli::Actual*) {
+        app.stopServing();
+        return 0;
+    });
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        cli::Application app("server", 1, 1, 1);
+        define(app);
+        return app.serve(socketPath());
+    }
+    std::vector<std::string> args(argv, argv + argc);
+    try {
+        return cli::forwardCommand(socketPath(), args);
+    } catch (const std::runtime_error&) {
+        // no server, pay the startup here
+        cli::Application app("server", 1, 1, 1);
+        define(app);
+        app.parse(args);
+        return app.execute();
+    }
+}
@@ -0,0 +1,49 @@
+#ifdef CLICMD_HEADER_ONLY
+#include "cli-cmd.hpp"
+#else
+#include "cli-cmd.h"
+#endif
+#include "static-schema.h"
+#include <iostream>
+
+int clone_(const cli::Actual* actual)
+{
+    std::cout << "clone " << actual->arguments[0].value << std::endl;
+    return 0;
+}
+
+int status_(const cli::Actual* actual)
+{
+    std::cout << "status" << (actual->containsFlag("--short") ? " (short)" : "") << std::endl;
+    return 0;
+}
+
+constexpr cli::StaticOption cloneOptions[] = {
+    cli::flag("--verbose", "-v", "be more verbose"),
+    cli::flag("--quiet", "-q", "be more quiet"),
+    cli::defParameter("--origin", "-o", "use <name> instead of 'origin' to track upstream", "identifier", "origin"),
+};
+
+constexpr cli::StaticArgument cloneArguments[] = {
+    cli::arg("repository", "url path"),
+    cli::args("directory", "auto-path", 0, 1),
+};
+
+constexpr cli::StaticOption statusOptions[] = {
+    cli::flag("--short", "-s", "give the output in the short-format"),
+};
+
+constexpr cli::StaticCommand commands[] = {
+    cli::command("status", "Show the working tree status", statusOptions, status_),
+    cli::command("clone", "Clone a repository into a new directory", cloneOptions, cloneArguments, clone_),
+    cli::command("init", "Create an empty Git repository"),
+};
+
+constexpr cli::StaticSchema schema(commands, true);
+static_assert(schema.find("clone") != nullptr, "clone is in schema");
+
+int main(int argc, char** argv) {
+    cli::Application app("staticschema", 1, 1, 1);
+    app.addCommands(schema);
+    return app.run(argc, argv);
+}
@@ -1,14 +1,26 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <fstream>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <utility>
 
 #include "cli-cmd.h"
 #include "distance.h"
 #include "error_codes.h"
+#include "overlay.h"
+#include "response-file.h"
+#include "static-schema.h"
+#include "utf8.h"
 #include "util.h"
 #include "validator.h"
 
@@ -18,10 +30,16 @@ namespace cli
         j = json{
                 {"name", v.argument.name()},
                 {"expectType", v.argument.expectType()},
-                {"value", v.value}
+                {"value", std::string(v.value)}
         };
     }
 
+    INLINE void to_json(json& j, const ArgumentList& list) {
+        j = json::array();
+        for (auto v : list)
+            j.push_back(v);
+    }
+
     INLINE void to_json(json& j, const Argument& v) {
         j = json{
                         {"name", v.name()},
@@ -65,6 +83,12 @@ namespace cli
                 };
         if (!p.description().empty())
             j["desc"] = p.description();
+        if (p.keyValue())
+            j["keyValue"] = true;
+        else if (p.repeatable())
+            j["repeatable"] = true;
+        if (p.separated())
+            j["separated"] = true;
     }
 
     INLINE void to_json(json& j, const Actual& a) {
@@ -73,6 +97,26 @@ namespace cli
             {"flag_set", a.flagSet},
             {"parameter_map", a.parameterMap},
             };
+        if (!a.mapValues.empty()) {
+            json maps = json::object();
+            for (const auto& [name, map] : a.mapValues) {
+                json pairs = json::object();
+                for (const auto& entry : map)
+                    pairs[std::string(entry.key)] = std::string(entry.value);
+                maps[name] = std::move(pairs);
+            }
+            j["map_values"] = std::move(maps);
+        }
+        if (!a.listRanges.empty()) {
+            json lists = json::object();
+            for (const auto& [name, range] : a.listRanges) {
+                json values = json::array();
+                for (auto value : a.getValues(name))
+                    values.push_back(std::string(value));
+                lists[name] = std::move(values);
+            }
+            j["list_map"] = std::move(lists);
+        }
         if (a.errNumber)
             j["error"] = to_string_errorCode(a.errNumber);
         j["arguments"] = a.arguments;
@@ -105,6 +149,12 @@ namespace cli
         if (f.vaArgs.max_n > 0) {
             j["varargs"] = f.vaArgs; // requires to_json(json&, const VaArguments&)
         }
+        if (!f.prefixMap.empty()) {
+            json prefixes = json::array();
+            for (const auto& [prefix, parameter] : f.prefixMap)
+                prefixes.push_back(*parameter);
+            j["prefixParameters"] = prefixes;
+        }
     }
 
     INLINE bool Actual::containsFlag(const std::string& opt) const
@@ -112,21 +162,115 @@ namespace cli
         auto tokenClass = (ArgType) classifyToken(opt, app->combineOpts);
         std::string baseOption;
         if (tokenClass == ShortOption) {
-            auto it = app->shorthandMap.find(opt);
-            if (it != app->shorthandMap.end()) {
-                baseOption = it->second;
+            auto name = app->resolveShorthand(opt);
+            if (name) {
+                baseOption = *name;
             } else return false;
         } else
             baseOption = opt;
         return flagSet.find(baseOption) != flagSet.end();
     }
 
+    INLINE void ArgumentList::emplace_back(const Argument& formal, std::string_view value) {
+        if (m_formals.empty() || m_formals.back() != &formal)
+            m_formals.push_back(&formal);
+        if (m_buffer.size() + value.size() > std::numeric_limits<uint32_t>::max())
+            throw std::length_error("positional arguments too long");
+        m_entries.push_back(Entry{static_cast<uint32_t>(m_formals.size() - 1),
+            static_cast<uint32_t>(m_buffer.size()), static_cast<uint32_t>(value.size())});
+        m_buffer += value;
+    }
+
+    INLINE void ArgumentList::clear() {
+        m_buffer.clear();
+        m_entries.clear();
+        m_formals.clear();
+    }
+
+    INLINE ArgumentValue ArgumentList::operator[](size_t index) const {
+        const auto& entry = m_entries[index];
+        return {*m_formals[entry.formal], std::string_view(m_buffer).substr(entry.offset, entry.size)};
+    }
+
+    INLINE ArgumentStream::ArgumentStream(const ArgumentList& list, size_t first, const Argument& formal):
+        m_list(&list), m_index(first), m_formal(&formal) {}
+
+    INLINE ArgumentStream::ArgumentStream(const ArgumentList& list, size_t first, const Argument& formal,
+        const std::string& source, std::istream* input, char separator):
+        m_list(&list), m_index(first), m_separator(separator), m_formal(&formal)
+    {
+        if (source == "-") {
+            m_in = input;
+            return;
+        }
+        m_file = std::make_unique<std::ifstream>(source, std::ios::binary);
+        m_in = m_file.get();
+        if (!*m_in) {
+            m_errorStr = fmt(ErrorMessage::ArgsSourceUnreadable, source.c_str());
+            m_errNumber = ErrorCode::ArgsSourceUnreadable;
+            m_in = nullptr;
+        }
+    }
+
+    INLINE bool ArgumentStream::next() {
+        if (m_index < m_list->size()) {
+            m_item = (*m_list)[m_index++].value;
+            return true;
+        }
+        if (!m_in || m_errNumber)
+            return false;
+        while (std::getline(*m_in, m_item, m_separator)) {
+            if (m_item.empty())
+                continue; // empty lines and trailing separator
+            std::string found;
+            if (!ValidatorManager::instance().validate(m_item, m_formal->expectType(), found)) {
+                m_errorStr = fmt(ErrorMessage::IsNotExpectedTypeArg, m_item.c_str(),
+                    m_formal->expectType().c_str(), m_formal->name().c_str());
+                m_errNumber = ErrorCode::IsNotExpectedTypeArg;
+                return false;
+            }
+            return true;
+        }
+        m_in = nullptr;
+        return false;
+    }
+
+    INLINE ArgumentStream Actual::streamArguments() const {
+        if (!streamFormal)
+            throw std::logic_error("command " + m_name + " has no variadic arguments");
+        if (argsSource.empty())
+            return {arguments, streamFirst, *streamFormal};
+        return {arguments, streamFirst, *streamFormal, argsSource, app->argsInput, argsSeparator};
+    }
+
     INLINE void Actual::clearActual() {
         arguments.clear();
         flagSet.clear();
+        parameterMap.clear();
         errNumber = 0;
         errorStr = "";
         mostSimilar.clear();
+        listBuffer.clear();
+        listValues.clear();
+        listRanges.clear();
+        mapValues.clear();
+        argsSource.clear();
+        argsSeparator = '\n';
+        integerValues.clear();
+        numberValues.clear();
+    }
+
+    INLINE ValueSpan Actual::getValues(const std::string& key) const {
+        auto it = listRanges.find(key);
+        if (it == listRanges.end())
+            return {};
+        return {listValues.data() + it->second.first, listValues.data() + it->second.second};
+    }
+
+    INLINE const ValueMap& Actual::getMap(const std::string& key) const {
+        static const ValueMap empty;
+        auto it = mapValues.find(key);
+        return it == mapValues.end() ? empty : it->second;
     }
 
     INLINE std::optional<std::string> Actual::getValue(const std::string& key) const {
@@ -168,9 +312,12 @@ namespace cli
     INLINE void Formal::addFlag(Application *app, const std::string &name, const std::string &shorthand,
                                 const std::string &desc)
     {
+        checkNotFrozen(app);
         if (isGlobal && app->globalOptionsLocked)
             throw std::logic_error("global options already locked. use this method before AddCommand");
         checkNames(app, name, shorthand);
+        if (prefixMap.count(name) || (!isGlobal && app->formal.prefixMap.count(name)))
+            throw std::invalid_argument(fmt("option '%s' already exists as prefix parameter", name.c_str()));
         addShorthand(app, name, shorthand);
         if (optionMap.find(name) != optionMap.end())
             throw std::invalid_argument(fmt("option '%s' already exists", name.c_str()));
@@ -182,22 +329,124 @@ namespace cli
 
     INLINE void Formal::addParameter(Application *app, const std::string& name, const std::string& shorthand,
         const std::string& desc, const std::string &expect, const std::string &defValue,
-        ParameterMode parameterMode)
+        ParameterMode parameterMode, bool repeatable, bool keyValue)
     {
         if (parameterMode == ParameterMode::Defaulted && defValue.empty())
             throw std::logic_error("default parameter can't be empty");
+        checkNotFrozen(app);
         if (isGlobal && app->globalOptionsLocked)
             throw std::logic_error("global options already locked. use this method before AddCommand");
         checkNames(app, name, shorthand);
+        if (prefixMap.count(name) || (!isGlobal && app->formal.prefixMap.count(name)))
+            throw std::invalid_argument(fmt("option '%s' already exists as prefix parameter", name.c_str()));
         addShorthand(app, name, shorthand);
         if (optionMap.find(name) != optionMap.end())
             throw std::invalid_argument(fmt("option '%s' already exists", name.c_str()));
         if (!isGlobal  && app->formal.optionMap.find(name) != app->formal.optionMap.end())
             throw std::invalid_argument(fmt("option '%s' already exists globally", name.c_str()));
-        auto parameter = std::make_shared<Parameter>(name, desc, defValue, expect, parameterMode);
+        auto parameter = std::make_shared<Parameter>(name, desc, defValue, expect, parameterMode, repeatable,
+            keyValue);
         optionMap[name] = parameter;
     }
 
+    /* names are checked at compile time by StaticSchema, only shorthands and globals are checked here */
+    INLINE void Formal::addStaticOption(Application *app, const StaticOption& option)
+    {
+        checkNotFrozen(app);
+        std::string name(option.name);
+        addShorthand(app, name, std::string(option.shorthand));
+        if (!isGlobal  && app->formal.optionMap.find(name) != app->formal.optionMap.end())
+            throw std::invalid_argument(fmt("option '%s' already exists globally", name.c_str()));
+        std::shared_ptr<Option> opt;
+        if (option.kind == OptionKind::Flag)
+            opt = std::make_shared<Flag>(name, std::string(option.desc));
+        else
+            opt = std::make_shared<Parameter>(name, std::string(option.desc), std::string(option.defValue),
+                std::string(option.expect), option.mode);
+        optionMap.emplace(std::move(name), std::move(opt));
+    }
+
+    INLINE void Formal::addPrefixParameter(Application *app, const std::string& prefix, const std::string& desc,
+        const std::string &expect, bool repeatable, bool separated)
+    {
+        checkNotFrozen(app);
+        if (isGlobal && app->globalOptionsLocked)
+            throw std::logic_error("global options already locked. use this method before AddCommand");
+        if (prefix.size() < 2 || prefix[0] != '-')
+            throw std::invalid_argument(fmt("prefix '%s' must start with dash and have at least one more character",
+                prefix.c_str()));
+        if (prefixMap.find(prefix) != prefixMap.end())
+            throw std::invalid_argument(fmt("prefix parameter '%s' already exists", prefix.c_str()));
+        // the same name would be two options, counted and stored apart
+        if (optionMap.count(prefix) || (!isGlobal && app->formal.optionMap.count(prefix)))
+            throw std::invalid_argument(fmt("prefix parameter '%s' already exists as option", prefix.c_str()));
+        prefixMap[prefix] = std::make_shared<Parameter>(prefix, desc, "", expect, ParameterMode::Optional, repeatable,
+            false, separated);
+    }
+
+    /* no lookups here, see checkPending */
+    INLINE void Formal::appendOptions(Application *app, const std::vector<StaticOption>& options)
+    {
+        checkNotFrozen(app);
+        if (isGlobal && app->globalOptionsLocked)
+            throw std::logic_error("global options already locked. use this method before AddCommand");
+        if (pendingOptions.empty() && !options.empty())
+            app->pendingFormals.push_back(this);
+        pendingOptions.reserve(pendingOptions.size() + options.size());
+        for (const auto& option : options) {
+            std::string name(option.name);
+            app->pendingShorthands.emplace_back(name, std::string(option.shorthand));
+            if (option.kind == OptionKind::Flag)
+                pendingOptions.push_back(std::make_shared<Flag>(std::move(name), std::string(option.desc)));
+            else {
+                if (option.mode == ParameterMode::Defaulted && option.defValue.empty())
+                    throw std::logic_error("default parameter can't be empty");
+                pendingOptions.push_back(std::make_shared<Parameter>(std::move(name), std::string(option.desc),
+                    std::string(option.defValue), std::string(option.expect), option.mode));
+            }
+        }
+    }
+
+    /* options are sorted by name */
+    INLINE bool pendingNamed(const std::vector<std::shared_ptr<Option>>& options, const std::string& name)
+    {
+        auto it = std::lower_bound(options.begin(), options.end(), name,
+            [](const auto& option, const std::string& key) { return option->name() < key; });
+        return it != options.end() && (*it)->name() == name;
+    }
+
+    /* same checks as addFlag/addParameter, but duplicates are found by sorting instead of lookups */
+    INLINE void Formal::checkPending(Application *app, const std::vector<std::shared_ptr<Option>>& globals)
+    {
+        auto& pending = pendingOptions;
+        std::sort(pending.begin(), pending.end(),
+            [](const auto& a, const auto& b) { return a->name() < b->name(); });
+        for (size_t i = 0; i < pending.size(); i++) {
+            const auto& name = pending[i]->name();
+            auto tokenClass = (ArgType) classifyToken(name, app->combineOpts);
+            if (!in(tokenClass, {LongOption, GccOption, ShortOption}))
+                throw std::invalid_argument(tokenError(name, {ArgType::LongOption, ArgType::GccOption,
+                    ArgType::ShortOption}, app->combineOpts));
+            if ((i > 0 && pending[i - 1]->name() == name) || (!optionMap.empty() && optionMap.count(name)))
+                throw std::invalid_argument(fmt("option '%s' already exists", name.c_str()));
+            if (!isGlobal && ((!app->formal.optionMap.empty() && app->formal.optionMap.count(name))
+                    || pendingNamed(globals, name)))
+                throw std::invalid_argument(fmt("option '%s' already exists globally", name.c_str()));
+            if ((!prefixMap.empty() && prefixMap.count(name)) || (!isGlobal && app->formal.prefixMap.count(name)))
+                throw std::invalid_argument(fmt("option '%s' already exists as prefix parameter", name.c_str()));
+        }
+    }
+
+    INLINE void Formal::mergePending()
+    {
+        auto pending = std::move(pendingOptions);
+        pendingOptions.clear();
+        // in descending order each insert is just before the previous one, so hint is exact
+        auto hint = optionMap.end();
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+            hint = optionMap.emplace_hint(hint, (*it)->name(), std::move(*it));
+    }
+
     INLINE json Command::asJson()
     {
         json j = *this;
@@ -218,14 +467,33 @@ namespace cli
         mostSimilar = app->proposeSimilar(arg);
     }
 
+    INLINE void Command::invalidUtf8(size_t argIndex, size_t offset)
+    {
+        errNumber = ErrorCode::InvalidUtf8;
+        errorStr = fmt(ErrorMessage::InvalidUtf8, static_cast<int>(argIndex), static_cast<int>(offset));
+    }
+
+    INLINE void Command::responseFileCycle(const std::string &path)
+    {
+        errNumber = ErrorCode::ResponseFileCycle;
+        errorStr = fmt(ErrorMessage::ResponseFileCycle, path.c_str());
+    }
+
+    INLINE void Command::ambiguousPrefix(const std::string &arg, std::vector<std::string> candidates)
+    {
+        errNumber = ErrorCode::AmbiguousPrefix;
+        errorStr = fmt(ErrorMessage::AmbiguousPrefix, arg.c_str());
+        mostSimilar = std::move(candidates);
+    }
+
     INLINE std::string Command::to_string() const
     {
-        std::string indent(3, ' ');
-        std::string result =  indent + m_name + std::string(std::max(1, 10 - static_cast<int>(m_name.size())), ' ') + m_desc;
+        std::string result = Application::commandLine(m_name, m_desc);
         if (m_name == "help")
         {
             if (app->cmdDepth == 3)
             {
+                std::string indent(3, ' ');
                 std::string blank(10, ' ');
                 result += "\n" + indent + blank + "--all : print all commands";
             }
@@ -247,6 +515,7 @@ namespace cli
 
     INLINE Command& Command::addArg(std::string name, std::string type)
     {
+        checkNotFrozen();
         Argument argument(std::move(name), std::move(type));
         formal.argList.push_back(argument);
         return *this;
@@ -254,6 +523,7 @@ namespace cli
 
     INLINE Command& Command::addArgs(std::string name, std::string type, size_t min_n, size_t max_n)
     {
+        checkNotFrozen();
         VaArguments argVa(std::move(name), std::move(type), min_n, max_n);
         this->formal.vaArgs = argVa;
         return *this;
@@ -264,6 +534,133 @@ namespace cli
         return addArgs(std::move(name), std::move(type), min_n, std::numeric_limits<size_t>::max());
     }
 
+    INLINE Command& Command::itemHandler(const ItemAction& action)
+    {
+        m_itemHandler = action;
+        m_handler = [](Actual* actual) { return static_cast<Command*>(actual)->runItems(); };
+        return *this;
+    }
+
+    INLINE int Command::runItems()
+    {
+        if (!streamFormal)
+            return 0;
+        int64_t jobs = 0;
+        auto jobsValue = getValue("--jobs");
+        if (!jobsValue || !parseInteger(*jobsValue, jobs) || jobs <= 0)
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+
+        struct Result {
+            std::string item;
+            std::ostringstream out;
+            int code = 0;
+            std::exception_ptr error;
+            bool done = false;
+        };
+        auto runItem = [this](Result& result) {
+            try {
+                result.code = m_itemHandler(this, result.item, result.out);
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+        };
+        int code = 0;
+        std::exception_ptr error;
+        auto collect = [&code, &error](Result& result) {
+            std::cout << result.out.str();
+            if (!code)
+                code = result.code;
+            if (!error)
+                error = result.error;
+        };
+        auto stream = streamArguments();
+        if (jobs <= 1) {
+            for (const auto& item : stream) {
+                Result result;
+                result.item = item;
+                runItem(result);
+                collect(result);
+            }
+        } else {
+            // idle worker takes the next queued item, so long items don't hold up others;
+            // reading stops while the window of uncollected items is full
+            size_t window = static_cast<size_t>(jobs) * 4;
+            std::deque<std::unique_ptr<Result>> inOrder; // read, not collected yet
+            std::deque<Result*> queued;                  // read, not taken by worker yet
+            bool closed = false;
+            std::mutex mutex;
+            std::condition_variable changed;
+            std::vector<std::thread> threads;
+            auto work = [&]() {
+                std::unique_lock<std::mutex> lock(mutex);
+                for (;;) {
+                    changed.wait(lock, [&] { return closed || !queued.empty(); });
+                    if (queued.empty())
+                        return;
+                    Result* result = queued.front();
+                    queued.pop_front();
+                    lock.unlock();
+                    runItem(*result);
+                    lock.lock();
+                    result->done = true;
+                    changed.notify_all();
+                }
+            };
+            auto it = stream.begin();
+            for (;;) {
+                for (; it != stream.end() && inOrder.size() < window; ++it) {
+                    auto result = std::make_unique<Result>();
+                    result->item = *it;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        queued.push_back(result.get());
+                        inOrder.push_back(std::move(result));
+                    }
+                    changed.notify_all();
+                    if (threads.size() < static_cast<size_t>(jobs))
+                        threads.emplace_back(work);
+                }
+                if (inOrder.empty())
+                    break;
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&inOrder] { return inOrder.front()->done; });
+                auto result = std::move(inOrder.front());
+                inOrder.pop_front();
+                lock.unlock();
+                collect(*result); // its buffer is released here
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            changed.notify_all();
+            for (auto& thread : threads)
+                thread.join();
+        }
+        std::cout.flush();
+        if (error)
+            std::rethrow_exception(error);
+        if (stream.errNumber()) {
+            errNumber = stream.errNumber();
+            errorStr = stream.errorStr();
+            printErrors();
+            return errNumber;
+        }
+        return code;
+    }
+
+    INLINE Command& Command::addArgsFrom()
+    {
+        checkNotFrozen();
+        if (formal.vaArgs.max_n != std::numeric_limits<size_t>::max())
+            throw std::logic_error("addArgsFrom needs variadic arguments without upper bound: " + m_name);
+        formal.addParameter(app, "--args-from", "", "Read arguments from <file>, `-` is standard input",
+            "string", "", ParameterMode::Optional);
+        formal.addFlag(app, "--null", "", "Arguments read by --args-from end with NUL, not newline");
+        m_argsFrom = true;
+        return *this;
+    }
+
     INLINE Command& Command::addFlag(const std::string& name, const std::string& shorthand, const std::string& desc)
     {
         formal.addFlag(app, name, shorthand, desc);
@@ -292,7 +689,7 @@ namespace cli
             for (const auto& p : parameterMap)
                 std::cout << p.first << " : " << p.second << std::endl;;
         }
-        else if (errNumber == ErrorCode::UnknownCommand) {
+        else if (errNumber == ErrorCode::UnknownCommand || errNumber == ErrorCode::AmbiguousPrefix) {
             printSimilars();
         }
     }
@@ -360,6 +757,7 @@ namespace cli
             if (!defValue.empty())
                 throw std::logic_error("default parameter must be empty for mode != Defaulted");
         }
+        checkNotFrozen();
         if (formal.optionMap.find(name) != formal.optionMap.end())
             throw std::invalid_argument(fmt("local option '%s' already exists", name.c_str()));
         auto it = app->formal.optionMap.find(name);
@@ -373,6 +771,7 @@ namespace cli
     }
 
     INLINE Command& Command::hideOption(const std::string& name) {
+        checkNotFrozen();
         if (formal.optionMap.find(name) != formal.optionMap.end())
             throw std::invalid_argument(fmt("local option '%s' already exists", name.c_str()));
         auto it = app->formal.optionMap.find(name);
@@ -382,8 +781,153 @@ namespace cli
         return *this;
     }
 
+    INLINE void Formal::checkNotFrozen(const Application* app) const
+    {
+        if (!materializing)
+            app->checkNotFrozen();
+    }
+
+    INLINE void Command::checkNotFrozen() const
+    {
+        formal.checkNotFrozen(app);
+    }
+
+    INLINE void Command::setMaterializing(bool on)
+    {
+        formal.materializing = on;
+        for (const auto& entry : subcommands)
+            entry.second->setMaterializing(on);
+    }
+
+    /* runs factory of stub; the definition was given before freeze, so this command (only) can change after it */
+    INLINE void Command::materialize() {
+        if (!m_factory)
+            return;
+        auto factory = std::move(m_factory);
+        m_factory = nullptr;
+        // what factory can change, put back when it throws, so the next dispatch runs it again
+        auto formalBefore = formal;
+        auto subcommandsBefore = subcommands;
+        auto handlerBefore = m_handler;
+        auto itemHandlerBefore = m_itemHandler;
+        bool argsFromBefore = m_argsFrom;
+        auto hiddenBefore = hiddenOptNames;
+        auto shorthandsBefore = app->shorthandMap;
+        size_t pendingShorthandsBefore = app->pendingShorthands.size();
+        setMaterializing(true);
+        try {
+            factory(*this);
+        } catch (...) {
+            formal = std::move(formalBefore);
+            subcommands = std::move(subcommandsBefore);
+            m_handler = std::move(handlerBefore);
+            m_itemHandler = std::move(itemHandlerBefore);
+            m_argsFrom = argsFromBefore;
+            hiddenOptNames = std::move(hiddenBefore);
+            app->shorthandMap = std::move(shorthandsBefore);
+            app->pendingShorthands.resize(pendingShorthandsBefore);
+            if (formal.pendingOptions.empty())
+                app->pendingFormals.erase(std::remove(app->pendingFormals.begin(), app->pendingFormals.end(), &formal),
+                    app->pendingFormals.end());
+            m_factory = std::move(factory);
+            setMaterializing(false);
+            throw;
+        }
+        setMaterializing(false);
+        buildMergedTree();
+    }
+
+    INLINE Command& Command::addPrefixParameter(const std::string& prefix, const std::string& desc,
+        const std::string &expect, bool repeatable, bool separated)
+    {
+        formal.addPrefixParameter(app, prefix, desc, expect, repeatable, separated);
+        return *this;
+    }
+
+    INLINE Command& Command::addListParameter(const std::string& name, const std::string& shorthand,
+        const std::string& desc, const std::string &expect)
+    {
+        formal.addParameter(app, name, shorthand, desc, expect, "", ParameterMode::Optional, true);
+        return *this;
+    }
+
+    INLINE Command& Command::addMapParameter(const std::string& name, const std::string& shorthand,
+        const std::string& desc, const std::string &expect)
+    {
+        formal.addParameter(app, name, shorthand, desc, expect, "", ParameterMode::Optional, true, true);
+        return *this;
+    }
+
+    /* option given by full name (or shorthand) wins over prefix */
+    INLINE const Parameter* Command::matchPrefix(const std::string& token) const
+    {
+        if (prefixIndex.empty() || token.size() < 2 || token[0] != '-')
+            return nullptr;
+        if (availableOptionMap.find(token.substr(0, token.find('='))) != availableOptionMap.end())
+            return nullptr;
+        auto prefix = prefixIndex.longestMatch(token);
+        if (!prefix)
+            return nullptr;
+        const Parameter* family = availablePrefixMap.find(*prefix)->second.get();
+        if (prefix->size() == token.size() && (!family->separated() || app->resolveShorthand(token)))
+            return nullptr;
+        return family;
+    }
+
+    INLINE Command& Command::addOptions(const std::vector<StaticOption>& options)
+    {
+        formal.appendOptions(app, options);
+        return *this;
+    }
+
+    INLINE Command& Command::addCommand(const std::string& token)
+    {
+        checkNotFrozen();
+        app->globalOptionsLocked = true;
+        auto errStr = tokenError(token, ArgType::BareIdentifier, app->combineOpts, app->unicodeIdentifiers);
+        if (!errStr.empty())
+            throw std::invalid_argument(errStr);
+        auto it = std::lower_bound(subcommands.begin(), subcommands.end(), token,
+            [](const auto& entry, const std::string& t) { return entry.first < t; });
+        if (it != subcommands.end() && it->first == token)
+            throw std::runtime_error("command already exist: " + m_name + " " + token);
+        auto command = std::make_shared<Command>(m_name + " " + token, app);
+        command->parent = this;
+        command->formal.materializing = formal.materializing;
+        it = subcommands.emplace(it, token, std::move(command));
+        return *it->second;
+    }
+
+    INLINE Command& Command::addCommand(const std::string& token, const std::string& desc, CommandFactory factory)
+    {
+        auto& command = addCommand(token).desc(desc);
+        command.m_factory = std::move(factory);
+        return command;
+    }
+
+    INLINE std::shared_ptr<Command> Command::findSubcommand(const std::string& token)
+    {
+        materialize();
+        auto it = std::lower_bound(subcommands.begin(), subcommands.end(), token,
+            [](const auto& entry, const std::string& t) { return entry.first < t; });
+        if (it == subcommands.end() || it->first != token)
+            return nullptr;
+        it->second->materialize();
+        return it->second;
+    }
+
+    /* for frozen application, which does not merge options on parse */
+    INLINE void Command::buildMergedTree() {
+        buildMergedOptions();
+        for (const auto& entry : subcommands)
+            entry.second->buildMergedTree();
+    }
+
     INLINE void Command::buildMergedOptions() {
         availableOptionMap = formal.optionMap;
+        for (const Command* ancestor = parent; ancestor; ancestor = ancestor->parent)
+            for (const auto& [key, value] : ancestor->formal.optionMap)
+                availableOptionMap.emplace(key, value);
         for (const auto& [key, value] : app->formal.optionMap) {
             if (availableOptionMap.find(key) == availableOptionMap.end())
                 availableOptionMap[key] = value;
@@ -391,6 +935,20 @@ namespace cli
         for (const auto& name: hiddenOptNames) {
             availableOptionMap.erase(name);
         }
+        availablePrefixMap = formal.prefixMap;
+        for (const Command* ancestor = parent; ancestor; ancestor = ancestor->parent)
+            availablePrefixMap.insert(ancestor->formal.prefixMap.begin(), ancestor->formal.prefixMap.end());
+        availablePrefixMap.insert(app->formal.prefixMap.begin(), app->formal.prefixMap.end());
+        std::vector<std::string> prefixes;
+        for (const auto& [key, _] : availablePrefixMap)
+            prefixes.push_back(key);
+        prefixIndex = PrefixIndex(std::move(prefixes));
+        if (app->frozen) {
+            std::vector<std::string> names;
+            for (const auto& [key, _] : availableOptionMap)
+                names.push_back(key);
+            optionIndex = PrefixIndex(std::move(names));
+        }
     }
 
     INLINE std::string Flag::to_string() const
@@ -402,8 +960,10 @@ namespace cli
     }
 
     INLINE Parameter::Parameter(std::string name, std::string description, std::string defVal, std::string expectType,
-                ParameterMode parameterMode) : Option(std::move(name), std::move(description)),m_expectType(std::move(expectType)),
-                m_parameterMode(parameterMode), m_defValue(std::move(defVal))
+                ParameterMode parameterMode, bool repeatable, bool keyValue, bool separated)
+                : Option(std::move(name), std::move(description)),
+                m_expectType(std::move(expectType)), m_parameterMode(parameterMode), m_defValue(std::move(defVal)),
+                m_repeatable(repeatable || keyValue), m_keyValue(keyValue), m_separated(separated)
     {
         auto& vm = ValidatorManager::instance();
         bool b = vm.testNames(this->m_expectType);
@@ -441,7 +1001,7 @@ namespace cli
         while (argNumber < args.size()) {
             auto& arg = args[argNumber];
             auto tokenClass = (ArgType) classifyToken(arg, app->combineOpts);
-            if (in(tokenClass, {ShortEquals, LongEquals, CompactEquals, GccEquals})) {
+            if (in(tokenClass, {ShortEquals, LongEquals, CompactEquals, GccEquals}) && !matchPrefix(arg)) {
                 auto p = splitEquals(arg);
                 separated.push_back(p.first);
                 separated.push_back(p.second);
@@ -464,7 +1024,7 @@ namespace cli
         while (argNumber < args.size()) {
             auto& arg = args[argNumber];
             auto tokenClass = (ArgType) classifyToken(arg, app->combineOpts);
-            if (tokenClass == CompactFlags) {
+            if (tokenClass == CompactFlags && !matchPrefix(arg)) {
                 for (size_t i = 1; i < arg.size(); i++) {
                     std::string newShort = "-";
                     newShort += arg[i];
@@ -478,6 +1038,8 @@ namespace cli
     }
 
     INLINE void Command::parse(int start, const std::vector<std::string>& args) {
+        if (!app->frozen) // frozen commands have merged options since freeze() or materialize()
+            buildMergedOptions();
         auto args1 = preprocessEquals(start, args);
         auto args2 = preprocessCompact(start, args1);
         return parsePreprocessed(start, args2);
@@ -487,16 +1049,52 @@ namespace cli
     INLINE void Command::parsePreprocessed(int start, const std::vector<std::string>& args)
     {
         clearActual();
-        buildMergedOptions();
         size_t count = 0, varCount = 0;
         std::map<std::string, int> optCount;
         for (const auto& [key, _] : availableOptionMap) {
             optCount[key] = 0;
         }
+        // repeatable values: parameter name, offset and size in listBuffer
+        std::vector<std::tuple<const Parameter*, size_t, size_t>> listed;
+        auto appendValue = [this, &listed](const Parameter* parameter, const std::string& value) {
+            listed.emplace_back(parameter, listBuffer.size(), value.size());
+            listBuffer += value;
+        };
+        auto numeric = numericKind(formal.vaArgs.expectType());
         size_t argNumber = start;
         while (argNumber < args.size())
         {
             auto arg = args[argNumber];
+            if (auto family = matchPrefix(arg)) {
+                const auto& name = family->name();
+                if (++optCount[name] > 1 && !family->repeatable()) {
+                    errorStr = fmt(ErrorMessage::OptionUsedTwice, name.c_str());
+                    errNumber = ErrorCode::OptionUsedTwice;
+                    return;
+                }
+                auto value = arg.substr(name.size());
+                if (arg.size() == name.size()) { // separated value
+                    if (++argNumber >= args.size()) {
+                        errorStr = fmt(ErrorMessage::UnexpectedCommandLineEnd, name.c_str());
+                        errNumber = ErrorCode::UnexpectedCommandLineEnd;
+                        return;
+                    }
+                    value = args[argNumber];
+                }
+                std::string found;
+                if (!ValidatorManager::instance().validate(value, family->expectType(), found)
+                        && !(overlay && overlay->extraChoice(m_name, name, value))) {
+                    errorStr = fmt(ErrorMessage::IsNotExpectedTypeParam, value.c_str(),
+                        family->expectType().c_str(), name.c_str());
+                    errNumber = ErrorCode::IsNotExpectedTypeParam;
+                    return;
+                }
+                if (family->repeatable())
+                    appendValue(family, value);
+                parameterMap[name] = std::move(value);
+                argNumber++;
+                continue;
+            }
             auto tokenClass = classifyToken(arg, app->combineOpts);
             std::string optStr;
             switch (tokenClass) {
@@ -504,9 +1102,9 @@ namespace cli
                     optStr = arg;
                     break;
                 case ShortOption: {
-                    auto it = app->shorthandMap.find(arg);
-                    if (it != app->shorthandMap.end()) {
-                        optStr = it->second;
+                    auto name = app->resolveShorthand(arg);
+                    if (name) {
+                        optStr = *name;
                     } else
                     {
                         errorStr = fmt(ErrorMessage::UnknownShortOption, arg.c_str());
@@ -519,6 +1117,18 @@ namespace cli
             }
             if (!optStr.empty()) {
                 auto it = availableOptionMap.find(optStr);
+                if (it == availableOptionMap.end() && tokenClass == LongOption && app->abbreviations
+                        && !optionIndex.empty()) {
+                    std::vector<std::string> candidates;
+                    auto name = optionIndex.resolve(optStr, candidates);
+                    if (name) {
+                        optStr = *name;
+                        it = availableOptionMap.find(optStr);
+                    } else if (!candidates.empty()) {
+                        ambiguousPrefix(optStr, std::move(candidates));
+                        return;
+                    }
+                }
                 if (it  == availableOptionMap.end())
                 {
                     errorStr = fmt(ErrorMessage::UnknownLongOption, optStr.c_str());
@@ -526,12 +1136,13 @@ namespace cli
                     return;
                 }
                 optCount[it->first]++;
-                if (optCount[optStr] > 1) {
+                auto opt = it->second.get();
+                if (optCount[optStr] > 1 && !(opt->kind() == OptionKind::Parameter
+                        && dynamic_cast<Parameter*>(opt)->repeatable())) {
                     errorStr = fmt(ErrorMessage::OptionUsedTwice, optStr.c_str());
                     errNumber = ErrorCode::OptionUsedTwice;
                     return;
                 }
-                auto opt = it->second.get();
                 if (opt->kind() == OptionKind::Flag)
                     flagSet.insert(optStr);
                 else if (opt->kind() == OptionKind::Parameter) {
@@ -547,43 +1158,116 @@ namespace cli
 
                     auto& vm = ValidatorManager::instance();
                     std::string found;
-                    bool validated = vm.validate(optArg,parameter->expectType(),found);
+                    std::string typed = optArg;
+                    if (parameter->keyValue()) {
+                        auto [key, value] = splitEquals(optArg);
+                        if (key.empty()) {
+                            errorStr = fmt(ErrorMessage::BadKeyValue, optArg.c_str(), arg.c_str());
+                            errNumber = ErrorCode::BadKeyValue;
+                            return;
+                        }
+                        typed = value;
+                    }
+                    bool validated = (parameter->keyValue() && typed.empty())
+                        || vm.validate(typed, parameter->expectType(), found)
+                        || (overlay && overlay->extraChoice(m_name, parameter->name(), typed));
                     if (!validated) {
-                        errorStr = fmt(ErrorMessage::IsNotExpectedTypeParam, optArg.c_str(),
+                        errorStr = fmt(ErrorMessage::IsNotExpectedTypeParam, typed.c_str(),
                             parameter->expectType().c_str(), arg.c_str());
                         errNumber = ErrorCode::IsNotExpectedTypeParam;
                         return;
                     }
+                    if (parameter->repeatable())
+                        appendValue(parameter, optArg);
                     parameterMap[parameter->name()] = optArg;
                 }
             }
             else
             {
-                Argument formalArgument("string","string");//default value when formal.vaArgs empty
+                if (m_argsFrom && arg == "-") {
+                    // `-` counts as the parameter, so `--args-from` given after it is also used twice
+                    if (++optCount["--args-from"] > 1) {
+                        errorStr = fmt(ErrorMessage::OptionUsedTwice, "--args-from");
+                        errNumber = ErrorCode::OptionUsedTwice;
+                        return;
+                    }
+                    parameterMap["--args-from"] = arg;
+                    argNumber++;
+                    continue;
+                }
+                static const Argument surplus("string", "string"); // when formal.vaArgs empty
+                const Argument* formalArgument = &surplus;
                 if (count < formal.argList.size())
                 {
-                    formalArgument = formal.argList[count++];
+                    formalArgument = &formal.argList[count++];
                 } else if (formal.vaArgs.max_n > 0)
                 {
-                    formalArgument = *static_cast<Argument*>(&formal.vaArgs);
+                    formalArgument = &formal.vaArgs;
                     varCount++;
+                    if (numeric != NumericKind::None) {
+                        arguments.emplace_back(*formalArgument, arg); // validated by convertNumbers
+                        argNumber++;
+                        continue;
+                    }
                 }
                 auto& vm = ValidatorManager::instance();
                 std::string found;
-                auto expectType = formalArgument.expectType();
-                bool validated = vm.validate(arg, expectType,found);
+                bool validated = vm.validate(arg, formalArgument->expectType(), found)
+                    || (overlay && overlay->extraChoice(m_name, formalArgument->name(), arg));
                 if (!validated) {
                     errorStr = fmt(ErrorMessage::IsNotExpectedTypeArg, arg.c_str(),
-                        formalArgument.expectType().c_str(), formalArgument.name().c_str());
+                        formalArgument->expectType().c_str(), formalArgument->name().c_str());
                     errNumber = ErrorCode::IsNotExpectedTypeArg;
                     return;
                 }
-                arguments.emplace_back(formalArgument, arg);
+                arguments.emplace_back(*formalArgument, arg);
             }
             argNumber++;
         }
+        // buffer is complete, views are stable now
+        std::stable_sort(listed.begin(), listed.end(),
+            [](const auto& a, const auto& b) { return std::get<0>(a)->name() < std::get<0>(b)->name(); });
+        listValues.reserve(listed.size());
+        for (const auto& [parameter, offset, size] : listed) {
+            auto& range = listRanges.try_emplace(parameter->name(), listValues.size(), listValues.size()).first->second;
+            listValues.emplace_back(listBuffer.data() + offset, size);
+            range.second = listValues.size();
+        }
+        for (const auto& [name, range] : listRanges) {
+            auto parameter = std::get<0>(listed[range.first]);
+            if (!parameter->keyValue())
+                continue;
+            auto& map = mapValues[name];
+            map.reserve(range.second - range.first);
+            for (size_t k = range.first; k < range.second; k++) {
+                auto pair = listValues[k];
+                auto eq = pair.find('=');
+                if (eq == std::string_view::npos)
+                    map.set(pair, {});
+                else
+                    map.set(pair.substr(0, eq), pair.substr(eq + 1));
+            }
+        }
+        if (numeric != NumericKind::None && !convertNumbers())
+            return;
+        if (m_argsFrom) {
+            auto source = parameterMap.find("--args-from");
+            if (source != parameterMap.end())
+                argsSource = source->second;
+            if (flagSet.count("--null"))
+                argsSeparator = '\0';
+        }
+        if (formal.vaArgs.max_n > 0) {
+            streamFormal = &formal.vaArgs;
+            streamFirst = formal.argList.size();
+        } else
+            streamFormal = nullptr;
         for (const auto& pair : optCount) {
             if (pair.second == 0) {
+                if (auto value = overlay ? overlay->defaultValue(m_name, pair.first) : nullptr) {
+                    parameterMap[pair.first] = *value;
+                    continue;
+                }
                 auto option = availableOptionMap[pair.first].get();
                 if (option->kind() != OptionKind::Parameter)
                     continue;
@@ -597,7 +1281,7 @@ namespace cli
                 }
             }
         }
-        if (arguments.size() < formal.argList.size() + formal.vaArgs.min_n)
+        if (arguments.size() < formal.argList.size() + (argsSource.empty() ? formal.vaArgs.min_n : 0))
         {
             errNumber = ErrorCode::TooFewArguments;
             if (arguments.size() > 1)
@@ -610,7 +1294,8 @@ namespace cli
                     formal.argList.size() + formal.vaArgs.min_n);
 
         }
-        else if (arguments.size() > formal.argList.size() + formal.vaArgs.max_n)
+        else if (arguments.size() > formal.argList.size()
+            && arguments.size() - formal.argList.size() > formal.vaArgs.max_n) // max_n can be unlimited
         {
             errNumber = ErrorCode::TooManyArguments;
             if (arguments.size() > 1)
@@ -630,6 +1315,34 @@ namespace cli
         }
     }
 
+    /* variadic arguments of numeric type are validated and converted here, in one pass */
+    INLINE bool Command::convertNumbers()
+    {
+        auto kind = numericKind(formal.vaArgs.expectType());
+        size_t first = std::min(formal.argList.size(), arguments.size());
+        size_t n = arguments.size() - first;
+        if (kind == NumericKind::Integer)
+            integerValues.resize(n);
+        else
+            numberValues.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            auto value = arguments[first + i].value;
+            bool converted = kind == NumericKind::Integer
+                ? parseInteger(value, integerValues[i])
+                : parseFloat(value, kind == NumericKind::Float, numberValues[i]);
+            if (!converted) {
+                std::string token(value);
+                errorStr = fmt(ErrorMessage::IsNotExpectedTypeArg, token.c_str(),
+                    formal.vaArgs.expectType().c_str(), formal.vaArgs.name().c_str());
+                errNumber = ErrorCode::IsNotExpectedTypeArg;
+                integerValues.clear();
+                numberValues.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
     INLINE void Command::parseHelpCommand(int start, const std::vector<std::string> &args) {
         clearActual();
         if (app->cmdDepth == 3)
@@ -638,12 +1351,22 @@ namespace cli
                     flagSet.insert(args[i]);
             }
         for (size_t i = start; i < args.size(); i++) {
-            int type = classifyToken(args[i], app->combineOpts);
+            int type = classifyToken(args[i], app->combineOpts, app->unicodeIdentifiers);
             if (type == BareIdentifier) {
-                Argument formalArgument("command", "identifier");
-                arguments.emplace_back(formalArgument, args[i]);
-                auto cmd = app->getCommand(args[i]);
-                cmd->buildMergedOptions();
+                // path of nested command, one argument per token
+                static const Argument formalArgument("command", "identifier");
+                size_t next;
+                std::vector<std::string> candidates;
+                auto cmd = app->dispatch(args, i, next, candidates, overlay);
+                const Command* top = cmd.get();
+                while (top && top->parent)
+                    top = top->parent;
+                // abbreviation of top command is resolved by dispatch
+                arguments.emplace_back(formalArgument, top ? top->m_name : args[i]);
+                for (size_t k = i + 1; k < next; k++)
+                    arguments.emplace_back(formalArgument, args[k]);
+                if (cmd && !app->frozen) // shared by all parses of frozen application
+                    cmd->buildMergedOptions();
                 break;
             }
         }
@@ -651,8 +1374,9 @@ namespace cli
 
     INLINE Command& Category::addCommand(std::string commandName)
     {
+        app->checkNotFrozen();
         app->globalOptionsLocked = true;
-        auto errStr = tokenError(commandName, ArgType::BareIdentifier, app->combineOpts);
+        auto errStr = tokenError(commandName, ArgType::BareIdentifier, app->combineOpts, app->unicodeIdentifiers);
         if (!errStr.empty())
             throw std::invalid_argument(errStr);
         if (commandName == "help")
@@ -666,9 +1390,17 @@ namespace cli
         } else throw std::runtime_error("command already exist: " + commandName);
     }
 
+    INLINE Command& Category::addCommand(std::string commandName, const std::string& desc, CommandFactory factory)
+    {
+        auto& command = addCommand(std::move(commandName)).desc(desc);
+        command.m_factory = std::move(factory);
+        return command;
+    }
+
     INLINE Category& Category::ref(const std::string& commandName)
     {
-        auto errStr = tokenError(commandName, ArgType::BareIdentifier, app->combineOpts);
+        app->checkNotFrozen();
+        auto errStr = tokenError(commandName, ArgType::BareIdentifier, app->combineOpts, app->unicodeIdentifiers);
         if (!errStr.empty())
             throw std::invalid_argument(errStr);
         auto it = app->commandMap.find(commandName);
@@ -685,6 +1417,7 @@ namespace cli
 
     INLINE Category* Application::addCategory(const std::string& caption)
     {
+        checkNotFrozen();
         auto category = std::make_unique<Category>(caption, this);
         categories.push_back(std::move(category));
         return categories.back().get();
@@ -692,6 +1425,7 @@ namespace cli
 
     INLINE Category& Application::addHelpCategory(const std::string& caption)
     {
+        checkNotFrozen();
         auto category = std::make_unique<Category>(caption, this);
         helpCategories.push_back(std::move(category));
         return *helpCategories.back().get();
@@ -705,13 +1439,141 @@ namespace cli
             return 255;
     }
 
+    INLINE json Application::schemaAsJson() const
+    {
+        std::map<std::string, std::string> shorthands; // inverse of shorthandMap
+        for (const auto& [shorthand, name] : shorthandMap)
+            shorthands[name] = shorthand;
+        auto formalJson = [&shorthands](const Formal& f) {
+            json j = f;
+            for (auto* list : {&j["flags"], &j["parameters"]})
+                for (auto& opt : *list) {
+                    auto it = shorthands.find(opt["name"].get<std::string>());
+                    if (it != shorthands.end() && it->second != it->first)
+                        opt["shorthand"] = it->second;
+                }
+            return j;
+        };
+        std::function<json(const std::string&, Command&)> commandJson;
+        commandJson = [&](const std::string& name, Command& cmd) {
+            cmd.materialize();
+            json j{
+                {"name", name},
+                {"desc", cmd.m_desc},
+                {"formal", formalJson(cmd.formal)},
+            };
+            if (!cmd.hiddenOptNames.empty())
+                j["hidden"] = cmd.hiddenOptNames;
+            if (cmd.m_argsFrom)
+                j["argsFrom"] = true;
+            if (!cmd.subcommands.empty()) {
+                json subs = json::array();
+                for (const auto& [token, sub] : cmd.subcommands)
+                    subs.push_back(commandJson(token, *sub));
+                j["commands"] = std::move(subs);
+            }
+            return j;
+        };
+        auto categoriesJson = [](const std::vector<std::unique_ptr<Category>>& list) {
+            json result = json::array();
+            for (const auto& category : list) {
+                json names = json::array();
+                for (const auto& cmd : category->commands)
+                    names.push_back(cmd->m_name);
+                result.push_back(json{{"desc", category->description}, {"commands", names}});
+            }
+            return result;
+        };
+        json cmds = json::array();
+        for (const auto& [name, cmd] : commandMap)
+            cmds.push_back(commandJson(name, *cmd));
+        json j{
+            {"app", appName},
+            {"combineOpts", combineOpts},
+            {"global", formalJson(formal)},
+            {"commands", cmds},
+        };
+        if (!categories.empty())
+            j["categories"] = categoriesJson(categories);
+        if (!helpCategories.empty())
+            j["helpCategories"] = categoriesJson(helpCategories);
+        return j;
+    }
+
     INLINE std::shared_ptr<Command> Application::getCommand(const std::string& name)
     {
+        auto command = findCommand(name);
+        if (command) {
+            return command;
+        } else
+            throw std::runtime_error("command not found: " + name);
+    }
+
+    INLINE std::shared_ptr<Command> Application::findCommand(const std::string& name)
+    {
+        validatePending();
         auto it = commandMap.find(name);
         if (it != commandMap.end()) {
+            it->second->materialize();
             return it->second;
-        } else
-            throw std::runtime_error("command not found: " + name);
+        }
+        if (snapshot) {
+            auto index = snapshot->findCommand(name);
+            if (index)
+                return materialize(*index);
+        }
+        return nullptr;
+    }
+
+    INLINE std::shared_ptr<Command> Application::resolveCommand(const std::string& token,
+        std::vector<std::string>& candidates, const SchemaOverlay* overlay)
+    {
+        auto command = findCommand(token);
+        if (command && overlay && overlay->hides(command->m_name))
+            command = nullptr;
+        if (command || !abbreviations || !frozen || commandNames().empty())
+            return command;
+        auto name = commandIndex.resolve(token, candidates);
+        if (overlay) {
+            if (name && overlay->hides(*name))
+                name = nullptr;
+            candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                [overlay](const std::string& candidate) { return overlay->hides(candidate); }), candidates.end());
+            if (candidates.size() == 1) { // the only visible one of ambiguous names
+                command = findCommand(candidates.front());
+                candidates.clear();
+                return command;
+            }
+        }
+        return name ? findCommand(*name) : nullptr;
+    }
+
+    INLINE std::shared_ptr<Command> Application::dispatch(const std::vector<std::string>& args, size_t start,
+        size_t& next, std::vector<std::string>& candidates, const SchemaOverlay* overlay)
+    {
+        auto command = resolveCommand(args[start], candidates, overlay);
+        next = start + 1;
+        while (command && next < args.size() && !command->subcommands.empty()) {
+            auto child = command->findSubcommand(args[next]);
+            if (!child || (overlay && overlay->hides(child->m_name)))
+                break;
+            command = child;
+            next++;
+        }
+        return command;
+    }
+
+    INLINE std::optional<std::string> Application::resolveShorthand(const std::string& shorthand) const
+    {
+        auto it = shorthandMap.find(shorthand);
+        if (it != shorthandMap.end())
+            return it->second;
+        if (snapshot) {
+            auto name = snapshot->findShorthand(shorthand);
+            if (name)
+                return std::string(*name);
+        }
+        return std::nullopt;
     }
 
     INLINE std::vector<std::string>  Application::proposeSimilar(const std::string& arg) const
@@ -720,6 +1582,12 @@ namespace cli
         keys.reserve(commandMap.size());
         std::transform(commandMap.begin(), commandMap.end(), std::back_inserter(keys),
                        [](const auto& pair) { return pair.first; });
+        if (snapshot)
+            for (size_t i = 0; i < snapshot->commandCount(); i++) {
+                std::string name(snapshot->commandName(i));
+                if (commandMap.find(name) == commandMap.end())
+                    keys.push_back(std::move(name));
+            }
         keys.emplace_back("--help");
         if (helpAvailability > 0)
             keys.emplace_back("help");
@@ -737,39 +1605,355 @@ namespace cli
 
     INLINE void Application::parse(const std::vector<std::string>& args)
     {
+        if (responseFiles && std::any_of(args.begin() + std::min<size_t>(1, args.size()), args.end(),
+                [](const std::string& arg) { return arg.size() > 1 && arg[0] == '@'; })) {
+            std::vector<std::string> expanded;
+            auto cycle = expandResponseFiles(args, expanded);
+            if (!cycle.empty()) {
+                currentCommand = std::make_shared<Command>(appName, this);
+                currentCommand->responseFileCycle(cycle);
+                return;
+            }
+            parseExpanded(expanded);
+        } else
+            parseExpanded(args);
+    }
+
+    INLINE std::shared_ptr<Command> Application::route(const std::vector<std::string>& args, size_t& start,
+        Route& how, const SchemaOverlay* overlay)
+    {
+        how = Route::Done;
+        if (checkUtf8)
+            for (size_t i = 1; i < args.size(); i++) {
+                size_t offset = findInvalidUtf8(args[i].data(), args[i].size());
+                if (offset != std::string::npos) {
+                    auto error = std::make_shared<Command>(appName, this);
+                    error->invalidUtf8(i, offset);
+                    return error;
+                }
+            }
+        if (args.size() > 1 && args[1] == "__complete") {
+            // hidden protocol of shell completion, words are not parsed as options
+            auto command = std::make_shared<Command>(args[1], this);
+            // executed as currentCommand it is the whole process, else a request among others
+            command->m_handler = [this, args, overlay](Actual* actual) {
+                return printCompletions(args, overlay, actual == currentCommand.get());
+            };
+            return command;
+        }
         if (helpAvailability > 0 && args.size()>1 && args[1] == "help") {
-            currentCommand = helpCommand;
-            currentCommand->parseHelpCommand(2, args);
-            return;
+            how = Route::Help;
+            start = 2;
+            return helpCommand;
         }
         if (findHelpOption(args)) {
-            currentCommand = helpCommand;
-            currentCommand->parseHelpCommand(1, args);
-            return;
+            how = Route::Help;
+            start = 1;
+            return helpCommand;
         }
-        if (cmdDepth == 0)
+        if (cmdDepth == 0) {
+            how = Route::Parse;
+            start = 1;
+            return mainCommand;
+        }
+        if (args.size() < 2)
+            return mainCommand;
+        size_t next;
+        std::vector<std::string> candidates;
+        auto command = dispatch(args, 1, next, candidates, overlay);
+        if (!command)
         {
-            currentCommand = mainCommand;
-            currentCommand->parse(1, args);
+            auto error = std::make_shared<Command>(args[1], this);
+            if (candidates.empty())
+                error->commandNotFound(args[1]);
+            else
+                error->ambiguousPrefix(args[1], std::move(candidates));
+            return error;
         }
-        else
+        if (!command->m_handler && !command->subcommands.empty() && next < args.size()
+            && classifyToken(args[next], combineOpts, unicodeIdentifiers) == BareIdentifier)
         {
-            if (args.size() < 2) {
-                currentCommand = mainCommand;
-                return;
+            // group without own handler, token after it must be one of nested commands
+            auto error = std::make_shared<Command>(command->m_name + " " + args[next], this);
+            error->commandNotFound(args[next]);
+            std::vector<std::string> tokens;
+            for (const auto& entry : command->subcommands)
+                if (!overlay || !overlay->hides(entry.second->m_name))
+                    tokens.push_back(entry.first);
+            error->mostSimilar = findMostSimilar(args[next], tokens);
+            return error;
+        }
+        how = Route::Parse;
+        start = next;
+        return command;
+    }
+
+    INLINE void Application::parseExpanded(const std::vector<std::string>& args)
+    {
+        validatePending();
+        size_t start = 0;
+        Route how;
+        currentCommand = route(args, start, how);
+        if (how == Route::Parse)
+            currentCommand->parse(static_cast<int>(start), args);
+        else if (how == Route::Help)
+            currentCommand->parseHelpCommand(static_cast<int>(start), args);
+    }
+
+    INLINE std::vector<CompletionCandidate> Application::complete(const std::vector<std::string>& words, size_t cword,
+        const SchemaOverlay* overlay)
+    {
+        IncrementalParser parser(*this, overlay);
+        cword = std::min(cword, words.size());
+        std::string_view partial = cword < words.size() ? std::string_view(words[cword]) : std::string_view();
+        parser.assign(words.data() + std::min<size_t>(1, cword), words.data() + cword, partial);
+        return parser.candidates();
+    }
+
+    INLINE int Application::printCompletions(const std::vector<std::string>& args, const SchemaOverlay* overlay,
+        bool oneShot)
+    {
+        int64_t cword;
+        if (args.size() < 3 || !parseInteger(args[2], cword) || cword < 1)
+            return 1;
+        std::vector<std::string> words(args.begin() + 3, args.end());
+        IncrementalParser parser(*this, overlay);
+        size_t n = std::min(static_cast<size_t>(cword), words.size());
+        std::string_view partial = n < words.size() ? std::string_view(words[n]) : std::string_view();
+        const auto& e = parser.assign(words.data() + std::min<size_t>(1, n), words.data() + n, partial);
+        // shell waits for this process, so slow value sources are left to detached processes,
+        // which fill the cache for the next completion (resident server just lets them run)
+        auto candidates = parser.candidates(oneShot);
+        std::string out;
+        for (const auto& candidate : candidates) {
+            out += candidate.value;
+            out += '\t';
+            out += candidate.description;
+            if (!candidate.group.empty())
+                out += '\t' + candidate.group;
+            out += '\n';
+        }
+        out += ':';
+        if (e.parameter)
+            out += e.parameter->expectType();
+        else if (e.kind == ExpectKind::Token && e.argument)
+            out += e.argument->expectType();
+        out += '\n';
+        std::cout << out << std::flush;
+        return 0;
+    }
+
+    INLINE void Application::materializeAll()
+    {
+        if (snapshot)
+            for (size_t i = 0; i < snapshot->commandCount(); i++)
+                findCommand(std::string(snapshot->commandName(i)));
+        std::vector<Command*> stack;
+        for (const auto& [name, command] : commandMap)
+            stack.push_back(command.get());
+        while (!stack.empty()) {
+            auto command = stack.back();
+            stack.pop_back();
+            command->materialize();
+            for (const auto& entry : command->subcommands)
+                stack.push_back(entry.second.get());
+        }
+    }
+
+    INLINE std::vector<ParseResult> Application::parseBatch(const std::vector<std::string_view>& lines, unsigned jobs)
+    {
+        // after this, routing only reads the schema and can run in parallel
+        freeze();
+        materializeAll();
+        std::vector<ParseResult> results(lines.size());
+        constexpr size_t Chunk = 64;
+        if (jobs == 0)
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        size_t workers = std::min<size_t>(jobs, (lines.size() + Chunk - 1) / Chunk);
+        std::atomic<size_t> next{0};
+        auto work = [this, &lines, &results, &next]() {
+            std::map<const Command*, std::unique_ptr<Command>> scratch; // copies of commands, reused by lines
+            std::vector<std::string> args{appName};
+            for (size_t first = next.fetch_add(Chunk); first < lines.size(); first = next.fetch_add(Chunk))
+                for (size_t i = first; i < std::min(first + Chunk, lines.size()); i++) {
+                    auto& result = results[i];
+                    splitStringWithQuotes(lines[i], args, 1);
+                    size_t start = 0;
+                    Route how;
+                    auto command = route(args, start, how);
+                    if (how == Route::Parse) {
+                        auto& copy = scratch[command.get()];
+                        if (!copy)
+                            copy = std::make_unique<Command>(*command);
+                        copy->parse(static_cast<int>(start), args);
+                        result.command = command.get();
+                        result.errNumber = copy->errNumber;
+                        if (copy->errNumber)
+                            result.errorStr = copy->errorStr.value_or("");
+                    } else if (how == Route::Help || command == mainCommand) {
+                        result.command = command.get();
+                    } else { // error of encoding or dispatch
+                        result.errNumber = command->errNumber;
+                        result.errorStr = command->errorStr.value_or("");
+                    }
+                }
+        };
+        if (workers <= 1)
+            work();
+        else {
+            std::vector<std::thread> threads;
+            for (size_t w = 0; w < workers; w++)
+                threads.emplace_back(work);
+            for (auto& thread : threads)
+                thread.join();
+        }
+        return results;
+    }
+
+    INLINE Command& Application::parseIsolated(const std::vector<std::string>& args, CommandScratch& scratch,
+        const SchemaOverlay* overlay)
+    {
+        std::vector<std::string> expanded;
+        const auto* line = &args;
+        if (responseFiles && std::any_of(args.begin() + std::min<size_t>(1, args.size()), args.end(),
+                [](const std::string& arg) { return arg.size() > 1 && arg[0] == '@'; })) {
+            auto cycle = expandResponseFiles(args, expanded);
+            if (!cycle.empty()) {
+                scratch.error = std::make_shared<Command>(appName, this);
+                scratch.error->responseFileCycle(cycle);
+                return *scratch.error;
             }
-            auto it = commandMap.find(args[1]);
-            if (it == commandMap.end())
-            {
-                currentCommand = std::make_shared<Command>(args[1], this);
-                currentCommand->commandNotFound(args[1]);
+            line = &expanded;
+        }
+        size_t start = 0;
+        Route how;
+        auto command = route(*line, start, how, overlay);
+        if (how == Route::Parse && overlay && overlay->hides(command->m_name)) {
+            command = std::make_shared<Command>((*line)[1], this);
+            command->commandNotFound((*line)[1]);
+            how = Route::Done;
+        }
+        if (how == Route::Done) { // new command with error, or mainCommand, which is not parsed
+            if (overlay)
+                command->mostSimilar.erase(std::remove_if(command->mostSimilar.begin(), command->mostSimilar.end(),
+                    [overlay](const std::string& name) { return overlay->hides(name); }), command->mostSimilar.end());
+            scratch.error = command;
+            return *command;
+        }
+        auto& copy = scratch.copies[command.get()];
+        if (!copy)
+            copy = std::make_unique<Command>(*command);
+        copy->overlay = overlay;
+        if (how == Route::Parse)
+            copy->parse(static_cast<int>(start), *line);
+        else
+            copy->parseHelpCommand(static_cast<int>(start), *line);
+        return *copy;
+    }
+
+    INLINE int Application::runScript(const std::string& path)
+    {
+        auto file = MappedFile::open(path);
+        if (!file)
+            throw std::runtime_error(fmt("can't open script '%s'", path.c_str()));
+        // ring of tokenized lines: helper thread fills slots, this thread parses and executes them
+        struct Slot {
+            std::vector<std::string> args;
+            size_t line = 0;
+        };
+        constexpr size_t Depth = 64;
+        std::vector<Slot> ring(Depth);
+        for (auto& slot : ring)
+            slot.args.push_back(appName);
+        size_t produced = 0, consumed = 0;
+        bool finished = false, cancelled = false;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::thread tokenizer([&]() {
+            std::string_view text = file->view();
+            size_t number = 0;
+            while (!text.empty()) {
+                auto end = text.find('\n');
+                auto line = text.substr(0, end);
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+                number++;
+                auto body = line.find_first_not_of(" \t\r\f\v");
+                if (body == std::string_view::npos || line[body] == '#')
+                    continue;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() { return produced - consumed < Depth || cancelled; });
+                    if (cancelled)
+                        return;
+                }
+                // slot is not visible to consumer until produced is increased
+                auto& slot = ring[produced % Depth];
+                splitStringWithQuotes(line, slot.args, 1);
+                slot.line = number;
+                std::lock_guard<std::mutex> lock(mutex);
+                produced++;
+                changed.notify_all();
             }
-            else
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            changed.notify_all();
+        });
+        auto stop = [&]() {
             {
-                currentCommand = it->second;
-                currentCommand->parse(2, args);
+                std::lock_guard<std::mutex> lock(mutex);
+                cancelled = true;
+                changed.notify_all();
+            }
+            tokenizer.join();
+        };
+        int code = 0;
+        scriptLine = 0;
+        try {
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() { return consumed < produced || finished; });
+                    if (consumed == produced)
+                        break;
+                }
+                auto& slot = ring[consumed % Depth];
+                scriptLine = slot.line;
+                parse(slot.args);
+                code = execute();
+                std::lock_guard<std::mutex> lock(mutex);
+                consumed++;
+                changed.notify_all();
+                if (code != 0)
+                    break;
             }
+        } catch (...) {
+            stop();
+            throw;
+        }
+        stop();
+        return code;
+    }
+
+    INLINE int Application::repl(const std::string& prompt)
+    {
+        LineEditor editor;
+        return repl(editor, prompt);
+    }
+
+    INLINE int Application::repl(LineEditor& editor, const std::string& prompt)
+    {
+        std::string line;
+        std::vector<std::string> args{appName};
+        int code = 0;
+        while (editor.readLine(prompt, line)) {
+            splitStringWithQuotes(line, args, 1);
+            if (args.size() == 1)
+                continue;
+            editor.addHistory(line);
+            parse(args);
+            code = execute();
         }
+        return code;
     }
 
     INLINE void Application::parse(const std::string& line)
@@ -792,8 +1976,9 @@ namespace cli
 
     INLINE Command& Application::addCommand(std::string commandName)
     {
+        checkNotFrozen();
         globalOptionsLocked = true;
-        auto errStr = tokenError(commandName, ArgType::BareIdentifier, combineOpts);
+        auto errStr = tokenError(commandName, ArgType::BareIdentifier, combineOpts, unicodeIdentifiers);
         if (!errStr.empty())
             throw std::invalid_argument(errStr);
         if (commandName == "help")
@@ -807,6 +1992,174 @@ namespace cli
         } else throw std::runtime_error("command already exist: " + commandName);
     }
 
+    INLINE Command& Application::addCommand(std::string commandName, const std::string& desc, CommandFactory factory)
+    {
+        auto& command = addCommand(std::move(commandName)).desc(desc);
+        command.m_factory = std::move(factory);
+        return command;
+    }
+
+    INLINE Application& Application::addStaticCommands(const StaticCommand* staticCommands, size_t count,
+        bool schemaCombineOpts)
+    {
+        if (schemaCombineOpts != static_cast<bool>(combineOpts))
+            throw std::logic_error("static schema was checked for other combineOpts mode");
+        checkNotFrozen();
+        globalOptionsLocked = true;
+        commands.reserve(commands.size() + count);
+        for (size_t i = 0; i < count; i++) {
+            const auto& sc = staticCommands[i];
+            std::string commandName(sc.name);
+            // schema is sorted: a name after the last one is new, and its insert with hint at end is O(1)
+            bool inOrder = commandMap.empty() || std::prev(commandMap.end())->first < commandName;
+            if (!inOrder && commandMap.find(commandName) != commandMap.end())
+                throw std::runtime_error("command already exist: " + commandName);
+            auto command = std::make_shared<Command>(commandName, this);
+            command->m_desc = std::string(sc.desc);
+            if (sc.argumentCount || sc.optionCount)
+                command->m_factory = [&sc](Command& stub) { // tables are static, read on dispatch
+                    for (size_t k = 0; k < sc.argumentCount; k++) {
+                        const auto& a = sc.arguments[k];
+                        if (a.variadic)
+                            stub.addArgs(std::string(a.name), std::string(a.expect), a.min_n, a.max_n);
+                        else
+                            stub.addArg(std::string(a.name), std::string(a.expect));
+                    }
+                    for (size_t k = 0; k < sc.optionCount; k++)
+                        stub.formal.addStaticOption(stub.app, sc.options[k]);
+                };
+            if (sc.handler)
+                command->m_handler = sc.handler;
+            commands.push_back(command);
+            commandMap.emplace_hint(commandMap.end(), std::move(commandName), std::move(command));
+        }
+        return *this;
+    }
+
+    INLINE Application& Application::addOptions(const std::vector<StaticOption>& options)
+    {
+        formal.appendOptions(this, options);
+        return *this;
+    }
+
+    INLINE Application& Application::addCommands(const std::vector<StaticCommand>& commandTable)
+    {
+        checkNotFrozen();
+        globalOptionsLocked = true;
+        pendingCommands.reserve(pendingCommands.size() + commandTable.size());
+        for (const auto& sc : commandTable) {
+            auto command = std::make_shared<Command>(std::string(sc.name), this);
+            command->m_desc = std::string(sc.desc);
+            for (size_t k = 0; k < sc.argumentCount; k++) {
+                const auto& a = sc.arguments[k];
+                if (a.variadic)
+                    command->addArgs(std::string(a.name), std::string(a.expect), a.min_n, a.max_n);
+                else
+                    command->addArg(std::string(a.name), std::string(a.expect));
+            }
+            if (sc.optionCount)
+                command->formal.appendOptions(this, {sc.options, sc.options + sc.optionCount});
+            if (sc.handler)
+                command->m_handler = sc.handler;
+            pendingCommands.push_back(std::move(command));
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Checks bulk definitions in one pass: sorts them and compares neighbours
+     *
+     * Global options go first, as local options are checked against them.
+     * Commands are listed in help in order of addCommands.
+     */
+    INLINE void Application::validatePending()
+    {
+        if (pendingFormals.empty() && pendingShorthands.empty() && pendingCommands.empty())
+            return;
+        // everything is checked before anything is merged, so after exception the schema is as it was
+        std::stable_partition(pendingFormals.begin(), pendingFormals.end(), [](const Formal* f) { return f->isGlobal; });
+        static const std::vector<std::shared_ptr<Option>> none;
+        const auto& globals = !pendingFormals.empty() && pendingFormals.front()->isGlobal
+            ? pendingFormals.front()->pendingOptions : none;
+        for (auto* f : pendingFormals)
+            f->checkPending(this, globals);
+        if (!globals.empty()) {
+            // options added one by one to commands were checked before these global ones were added
+            std::vector<const Command*> commands;
+            for (const auto& entry : commandMap)
+                commands.push_back(entry.second.get());
+            if (mainCommand)
+                commands.push_back(mainCommand.get());
+            while (!commands.empty()) {
+                const auto* command = commands.back();
+                commands.pop_back();
+                for (const auto& entry : command->subcommands)
+                    commands.push_back(entry.second.get());
+                for (const auto& entry : command->formal.optionMap)
+                    if (pendingNamed(globals, entry.first))
+                        throw std::invalid_argument(fmt("option '%s' already exists globally", entry.first.c_str()));
+            }
+        }
+
+        std::vector<std::pair<std::string, std::string>> shorthands; // shorthand, option name
+        shorthands.reserve(pendingShorthands.size());
+        for (const auto& [name, given] : pendingShorthands) {
+            auto shorthand = given;
+            if (classifyToken(name, combineOpts) == ArgType::ShortOption) {
+                if (shorthand.empty())
+                    shorthand = name;
+                else if (shorthand != name)
+                    throw std::invalid_argument(fmt("two short forms are differ %s and %s",
+                        name.c_str(), shorthand.c_str()));
+            }
+            if (shorthand.empty())
+                continue;
+            auto errStr = tokenError(shorthand, ArgType::ShortOption, combineOpts);
+            if (!errStr.empty())
+                throw std::invalid_argument(errStr);
+            shorthands.emplace_back(std::move(shorthand), name);
+        }
+        std::sort(shorthands.begin(), shorthands.end());
+        for (size_t i = 0; i < shorthands.size(); i++) {
+            const auto& [shorthand, name] = shorthands[i];
+            auto it = shorthandMap.find(shorthand);
+            if (it != shorthandMap.end())
+                throw std::invalid_argument(fmt("shorthand %s already taken for option %s",
+                    shorthand.c_str(), it->second.c_str()));
+            if (i > 0 && shorthands[i - 1].first == shorthand)
+                throw std::invalid_argument(fmt("shorthand %s already taken for option %s",
+                    shorthand.c_str(), shorthands[i - 1].second.c_str()));
+        }
+
+        auto sorted = pendingCommands;
+        std::sort(sorted.begin(), sorted.end(),
+            [](const auto& a, const auto& b) { return a->m_name < b->m_name; });
+        for (size_t i = 0; i < sorted.size(); i++) {
+            const auto& name = sorted[i]->m_name;
+            auto errStr = tokenError(name, ArgType::BareIdentifier, combineOpts, unicodeIdentifiers);
+            if (!errStr.empty())
+                throw std::invalid_argument(errStr);
+            if (name == "help")
+                throw std::invalid_argument("Command name 'help' is reserved");
+            if ((i > 0 && sorted[i - 1]->m_name == name) || commandMap.find(name) != commandMap.end())
+                throw std::runtime_error("command already exist: " + name);
+        }
+
+        for (auto* f : pendingFormals)
+            f->mergePending();
+        pendingFormals.clear();
+        auto hint = shorthandMap.end();
+        for (auto it = shorthands.rbegin(); it != shorthands.rend(); ++it)
+            hint = shorthandMap.emplace_hint(hint, std::move(it->first), std::move(it->second));
+        pendingShorthands.clear();
+        auto added = std::move(pendingCommands);
+        pendingCommands.clear();
+        auto commandHint = commandMap.end();
+        for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+            commandHint = commandMap.emplace_hint(commandHint, (*it)->m_name, *it);
+        commands.insert(commands.end(), added.begin(), added.end());
+    }
+
     /**
      * @brief Display help message based on command hierarchy depth.
      *
@@ -821,47 +2174,73 @@ namespace cli
     {
         const bool bAll = actual->containsFlag("--all")
                         || actual->containsFlag("-a");
+        const auto* overlay = actual->overlay;
+        auto print = [overlay](const std::shared_ptr<Command>& cmd) {
+            if (!overlay || !overlay->hides(cmd->m_name))
+                std::cout << cmd->to_string() << std::endl;
+        };
 
         for (const auto& cmd : commands) {
-            std::cout << cmd->to_string() << std::endl;
+            print(cmd);
         }
+        printSnapshotCategories(SnapshotCategoryKind::TopLevel, overlay);
 
         if (cmdDepth == 2 || (cmdDepth == 3 && bAll)) {
             for (const auto& category_ptr : categories) {
                 std::cout << std::endl << category_ptr->description << std::endl;
                 for (const auto& cmd : category_ptr->commands) {
-                    std::cout << cmd->to_string() << std::endl;
+                    print(cmd);
                 }
             }
+            printSnapshotCategories(SnapshotCategoryKind::Category, overlay);
             return;
         } else if (cmdDepth == 3) {
             for (const auto& category_ptr : helpCategories)
             {
                 std::cout << std::endl << category_ptr->description << std::endl;
                 for (const auto& cmd : category_ptr->commands) {
-                    std::cout << cmd->to_string() << std::endl;
+                    print(cmd);
                 }
             }
+            printSnapshotCategories(SnapshotCategoryKind::HelpCategory, overlay);
         }
         return;
     }
 
+    INLINE std::string Application::commandLine(std::string_view name, std::string_view desc)
+    {
+        std::string indent(3, ' ');
+        return indent + std::string(name) + std::string(std::max(1, 10 - static_cast<int>(name.size())), ' ')
+            + std::string(desc);
+    }
+
     INLINE int Application::commandHelp(Actual* actual)
     {
-        auto arg = actual->arguments[0];
-        auto it = commandMap.find(arg.value);
-        if (it == commandMap.end())
+        std::string name(actual->arguments[0].value);
+        auto cmd = findCommand(name);
+        if (!cmd || (actual->overlay && actual->overlay->hides(name)))
         {
-            auto cmd = std::make_shared<Command>(arg.value, this);
-            cmd->commandNotFound(arg.value);
+            auto cmd = std::make_shared<Command>(name, this);
+            cmd->commandNotFound(name);
             cmd->printErrors();
             return 0;
         }
-        auto cmd = it->second;
+        for (size_t i = 1; i < actual->arguments.size() && cmd; i++)
+            cmd = cmd->findSubcommand(std::string(actual->arguments[i].value));
+        if (!cmd || (actual->overlay && actual->overlay->hides(cmd->m_name)))
+            return 0;
         std::cout << cmd->to_string() << std::endl;
         for (const auto& [key, opt] : cmd->availableOptionMap) {
             std::cout << opt->to_string() << std::endl;
         }
+        for (const auto& [key, opt] : cmd->availablePrefixMap) {
+            std::cout << opt->to_string() << std::endl;
+        }
+        if (!cmd->subcommands.empty()) {
+            std::cout << std::endl;
+            for (const auto& entry : cmd->subcommands)
+                std::cout << entry.second->to_string() << std::endl;
+        }
         return 0;
     }
 
@@ -926,6 +2305,7 @@ namespace cli
     INLINE void Application::registerValidators() {
         auto& vm = ValidatorManager::instance();
         vm.register_validator(std::make_unique<IdentifierValidator>());
+        vm.register_validator(std::make_unique<UnicodeIdentifierValidator>());
         vm.register_validator(std::make_unique<UrlValidator>());
         vm.register_validator(std::make_unique<LinuxPathValidator>());
         vm.register_validator(std::make_unique<WindowsPathValidator>());
@@ -948,6 +2328,12 @@ namespace cli
             throw std::invalid_argument("appName is empty");
         registerValidators();
         initSystemCommands();
+        const char* cache = std::getenv("XDG_CACHE_HOME");
+        const char* home = std::getenv("HOME");
+        if (cache && *cache)
+            valueCompleter.cacheDir = std::string(cache) + "/" + this->appName + "-completion";
+        else if (home && *home)
+            valueCompleter.cacheDir = std::string(home) + "/.cache/" + this->appName + "-completion";
     }
 
     INLINE std::vector<std::string> Application::findMostSimilar(const std::string& proposed, const std::vector<std::string> &keys)
@@ -974,33 +2360,43 @@ namespace cli
 
     INLINE std::vector<std::string> Application::splitStringWithQuotes(const std::string& input) {
         std::vector<std::string> result;
-        std::istringstream iss(input);
-        std::string token;
-        char currentQuote = '\0';
-
-        while (iss >> std::ws) {
-            char ch = static_cast<char>(iss.peek());
-
-            if ((ch == '"' || ch == '\'')) {
-                // The beginning of the quotation marks
-                currentQuote = ch;
-                iss.get(); // Download the quotation mark
-                std::string quotedToken;
-
-                while (iss.get(ch) && ch != currentQuote) {
-                    quotedToken += ch;
-                }
+        splitStringWithQuotes(input, result);
+        return result;
+    }
 
-                result.push_back(quotedToken);
+    /* token starting with quote ends at the closing one, other token at whitespace */
+    INLINE void Application::splitStringWithQuotes(std::string_view input, std::vector<std::string>& tokens,
+        size_t first) {
+        size_t count = first; // tokens before first are kept, strings are reused with their capacity
+        auto emit = [&tokens, &count](std::string_view token) {
+            if (count < tokens.size())
+                tokens[count].assign(token.data(), token.size());
+            else
+                tokens.emplace_back(token);
+            count++;
+        };
+        auto space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        size_t i = 0, n = input.size();
+        while (true) {
+            while (i < n && space(input[i]))
+                i++;
+            if (i == n)
+                break;
+            size_t start = i;
+            if (input[i] == '"' || input[i] == '\'') {
+                char quote = input[i];
+                auto end = input.find(quote, start + 1);
+                if (end == std::string_view::npos)
+                    end = n; // unterminated quotation takes the rest
+                emit(input.substr(start + 1, end - start - 1));
+                i = std::min(end + 1, n);
             } else {
-                // Normal token (without quotation marks)
-                std::string normalToken;
-                iss >> normalToken;
-                result.push_back(normalToken);
+                while (i < n && !space(input[i]))
+                    i++;
+                emit(input.substr(start, i - start));
             }
         }
-
-        return result;
+        tokens.resize(count);
     }
     // can be overridden
     INLINE Application& Application::addParameter(const std::string& name, const std::string& shorthand,
@@ -1010,6 +2406,13 @@ namespace cli
         return *this;
     }
 
+    INLINE Application& Application::addJobsOption()
+    {
+        formal.addParameter(this, "--jobs", "-j", "Number of items processed in parallel", "integer", "",
+            ParameterMode::Optional);
+        return *this;
+    }
+
     INLINE Application& Application::addReqParameter(const std::string& name, const std::string& shorthand,
         const std::string& desc, const std::string &expect)
     {
@@ -1030,4 +2433,25 @@ namespace cli
         return *this;
     }
 
+    INLINE Application& Application::addPrefixParameter(const std::string& prefix, const std::string& desc,
+        const std::string &expect, bool repeatable, bool separated)
+    {
+        formal.addPrefixParameter(this, prefix, desc, expect, repeatable, separated);
+        return *this;
+    }
+
+    INLINE Application& Application::addListParameter(const std::string& name, const std::string& shorthand,
+        const std::string& desc, const std::string &expect)
+    {
+        formal.addParameter(this, name, shorthand, desc, expect, "", ParameterMode::Optional, true);
+        return *this;
+    }
+
+    INLINE Application& Application::addMapParameter(const std::string& name, const std::string& shorthand,
+        const std::string& desc, const std::string &expect)
+    {
+        formal.addParameter(this, name, shorthand, desc, expect, "", ParameterMode::Optional, true, true);
+        return *this;
+    }
+
 }
@@ -1,11 +1,22 @@
 #pragma once
+#include "completion.h"
+#include "line-editor.h"
+#include "numeric.h"
+#include "prefix-index.h"
+#include "server.h"
+#include "snapshot.h"
 #include "util.h"
+#include "value-map.h"
+#include <cstdint>
 #include <functional>
+#include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -17,12 +28,26 @@ namespace cli
     struct Actual;
     class Application;
     class Command;
+    class SchemaOverlay;
     struct ArgumentValue;
+    class ArgumentList;
+    struct StaticOption;
+    struct StaticCommand;
+    template<size_t N> class StaticSchema;
 
     void to_json(json& j, const ArgumentValue& v);
+    void to_json(json& j, const ArgumentList& list);
     void to_json(json& j, const Actual& a);
 
     using Action = std::function<int(Actual*)>;
+    /**
+     * @brief Handler of one variadic argument, writes its output to out, see Command::itemHandler
+     */
+    using ItemAction = std::function<int(const Actual*, const std::string& item, std::ostream& out)>;
+    /**
+     * @brief Defines options and arguments of command registered as stub, see Application::addCommand
+     */
+    using CommandFactory = std::function<void(Command&)>;
 
     enum class OptionKind { Flag, Parameter };
 
@@ -66,13 +91,17 @@ namespace cli
         std::string m_expectType;
         ParameterMode m_parameterMode;
         std::string m_defValue;
+        bool m_repeatable = false;
+        bool m_keyValue = false;
+        bool m_separated = false;
     public:
         Parameter(std::string name, std::string description, std::string defVal, std::string expectType,
-            ParameterMode parameterMode);
+            ParameterMode parameterMode, bool repeatable = false, bool keyValue = false, bool separated = false);
 
         Parameter(const Parameter& base, ParameterMode overrideMode, std::string defVal = "")
                : Option(base.name(), base.description()),
-                m_expectType(base.m_expectType),m_parameterMode(overrideMode), m_defValue(std::move(defVal)) {}
+                m_expectType(base.m_expectType),m_parameterMode(overrideMode), m_defValue(std::move(defVal)),
+                m_repeatable(base.m_repeatable), m_keyValue(base.m_keyValue), m_separated(base.m_separated) {}
 
         [[nodiscard]] std::string to_string() const override;
         [[nodiscard]] OptionKind kind() const override {
@@ -87,6 +116,24 @@ namespace cli
         [[nodiscard]] std::string defValue() const {
             return m_defValue;
         }
+        /**
+         * @brief Can be given many times, all values are kept, see Actual::getValues
+         */
+        [[nodiscard]] bool repeatable() const {
+            return m_repeatable;
+        }
+        /**
+         * @brief Values are `key=value` pairs, expectType applies to value, see Actual::getMap
+         */
+        [[nodiscard]] bool keyValue() const {
+            return m_keyValue;
+        }
+        /**
+         * @brief Prefix parameter also takes value from the next token when given alone, as `-I dir`
+         */
+        [[nodiscard]] bool separated() const {
+            return m_separated;
+        }
     };
 
     class Argument
@@ -104,12 +151,51 @@ namespace cli
         }
     };
 
+    /**
+     * @brief Positional argument with its formal, view into ArgumentList
+     */
     struct ArgumentValue
     {
-        Argument argument;
-        std::string value;
-        ArgumentValue(Argument argument, std::string value):
-            argument(std::move(argument)), value(std::move(value)) {}
+        const Argument& argument;
+        std::string_view value;
+    };
+
+    /**
+     * @brief Positional arguments of Actual
+     *
+     * Values are copied back to back into one buffer, each positional is one entry
+     * of formal index and value range, formals are stored once (all values of variadic
+     * argument share one). Elements are ArgumentValue views, valid until next parse.
+     */
+    class ArgumentList
+    {
+        struct Entry {
+            uint32_t formal;
+            uint32_t offset;
+            uint32_t size;
+        };
+        std::string m_buffer;
+        std::vector<Entry> m_entries;
+        std::vector<const Argument*> m_formals;
+    public:
+        class iterator {
+            const ArgumentList* m_list;
+            size_t m_index;
+        public:
+            iterator(const ArgumentList* list, size_t index): m_list(list), m_index(index) {}
+            ArgumentValue operator*() const { return (*m_list)[m_index]; }
+            iterator& operator++() { m_index++; return *this; }
+            bool operator==(const iterator& other) const { return m_index == other.m_index; }
+            bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+        };
+        /* formal must outlive the list, it is Argument of Formal or static one */
+        void emplace_back(const Argument& formal, std::string_view value);
+        void clear();
+        [[nodiscard]] size_t size() const { return m_entries.size(); }
+        [[nodiscard]] bool empty() const { return m_entries.empty(); }
+        ArgumentValue operator[](size_t index) const;
+        [[nodiscard]] iterator begin() const { return {this, 0}; }
+        [[nodiscard]] iterator end() const { return {this, m_entries.size()}; }
     };
 
     struct VaArguments: public Argument
@@ -121,18 +207,127 @@ namespace cli
             Argument(std::move(name), std::move(type)), min_n(min_n), max_n(max_n){}
     };
 
+    /**
+     * @brief Variadic arguments of command line followed by items read from Actual::argsSource
+     *
+     * Items are read one at a time into the same buffer and validated against the variadic formal
+     * as they come, so memory doesn't grow with input. Iteration stops at end of input or at
+     * the first error, errNumber() tells which.
+     */
+    class ArgumentStream
+    {
+        const ArgumentList* m_list;
+        size_t m_index;
+        std::unique_ptr<std::istream> m_file;
+        std::istream* m_in = nullptr;
+        char m_separator = '\n';
+        const Argument* m_formal;
+        std::string m_item;
+        int m_errNumber = 0;
+        std::string m_errorStr;
+    public:
+        ArgumentStream(const ArgumentList& list, size_t first, const Argument& formal);
+        ArgumentStream(const ArgumentList& list, size_t first, const Argument& formal,
+            const std::string& source, std::istream* input, char separator);
+        /**
+         * @brief Reads next item, false at the end or on error
+         */
+        bool next();
+        [[nodiscard]] const std::string& item() const { return m_item; }
+        [[nodiscard]] int errNumber() const { return m_errNumber; }
+        [[nodiscard]] const std::string& errorStr() const { return m_errorStr; }
+
+        class iterator {
+            ArgumentStream* m_stream;
+        public:
+            explicit iterator(ArgumentStream* stream): m_stream(stream) {}
+            const std::string& operator*() const { return m_stream->item(); }
+            iterator& operator++() { if (!m_stream->next()) m_stream = nullptr; return *this; }
+            bool operator==(const iterator& other) const { return m_stream == other.m_stream; }
+            bool operator!=(const iterator& other) const { return m_stream != other.m_stream; }
+        };
+        iterator begin() { return next() ? iterator(this) : end(); }
+        iterator end() { return iterator(nullptr); }
+    };
+
+    /**
+     * @brief Contiguous read-only range of parse results
+     */
+    template<typename T>
+    struct Span
+    {
+        const T* first = nullptr;
+        const T* last = nullptr;
+        [[nodiscard]] const T* begin() const { return first; }
+        [[nodiscard]] const T* end() const { return last; }
+        [[nodiscard]] const T* data() const { return first; }
+        [[nodiscard]] size_t size() const { return last - first; }
+        [[nodiscard]] bool empty() const { return first == last; }
+        const T& operator[](size_t i) const { return first[i]; }
+    };
+
+    /**
+     * @brief Values of repeatable parameter
+     */
+    using ValueSpan = Span<std::string_view>;
+
     struct Actual
     {
         virtual ~Actual() = default;
         Application* app;
         std::string m_name;
         std::map<std::string, std::shared_ptr<Option>> availableOptionMap = {};
-        std::vector<ArgumentValue> arguments;
+        ArgumentList arguments;
         std::set<std::string> flagSet;
         std::map<std::string, std::string> parameterMap;
+        /**
+         * @brief Values of repeatable parameters
+         *
+         * Values are copied back to back into one buffer while parsing, at the end views are
+         * grouped by parameter in command line order, so getValues returns one contiguous span.
+         * parameterMap keeps the last value.
+         */
+        std::string listBuffer;
+        std::vector<std::string_view> listValues;
+        std::map<std::string, std::pair<size_t, size_t>> listRanges;
+        [[nodiscard]] ValueSpan getValues(const std::string &key) const;
+        /**
+         * @brief Pairs of key=value parameter, later value of the same key wins
+         */
+        std::map<std::string, ValueMap> mapValues;
+        [[nodiscard]] const ValueMap& getMap(const std::string &key) const;
+        /**
+         * @brief File given by `--args-from` or `-` for standard input, empty when arguments are only in argv
+         */
+        std::string argsSource;
+        char argsSeparator = '\n';
+        /**
+         * @brief Variadic arguments, streamed from argsSource after those of command line, see Command::addArgsFrom
+         */
+        [[nodiscard]] ArgumentStream streamArguments() const;
+        const Argument* streamFormal = nullptr;
+        size_t streamFirst = 0;
+        /**
+         * @brief Variadic arguments of type `integer`, converted in one pass after parse
+         */
+        std::vector<int64_t> integerValues;
+        /**
+         * @brief Variadic arguments of type `decimal`, `float` or `number`
+         */
+        std::vector<double> numberValues;
+        [[nodiscard]] Span<int64_t> getIntegers() const {
+            return {integerValues.data(), integerValues.data() + integerValues.size()};
+        }
+        [[nodiscard]] Span<double> getNumbers() const {
+            return {numberValues.data(), numberValues.data() + numberValues.size()};
+        }
         int errNumber = 0;
         std::optional<std::string> errorStr;
         std::vector<std::string> mostSimilar;
+        /**
+         * @brief Overlay (tenant) whose schema parsed this, nullptr for the base schema
+         */
+        const SchemaOverlay* overlay = nullptr;
         [[nodiscard]] bool containsFlag(const std::string &opt) const;
         Actual(Application* app, std::string commandName): app(app), m_name(std::move(commandName)){}
         void clearActual();
@@ -144,6 +339,13 @@ namespace cli
         static void checkNames(Application *app, const std::string &name, const std::string &shorthand);
         static void addShorthand(Application *app, const std::string &name, std::string shorthand);
         bool isGlobal;
+        /**
+         * @brief Set while factory of its command runs, which can add to it in frozen application
+         */
+        bool materializing = false;
+        void checkNotFrozen(const Application* app) const;
+        friend class Application;
+        friend class Command;
     public:
         explicit Formal(bool isGlobal):isGlobal(isGlobal){}
         std::map<std::string, std::shared_ptr<Option>> optionMap = {};
@@ -152,34 +354,106 @@ namespace cli
         void addFlag(Application* app, const std::string& name, const std::string& shorthand, const std::string& desc);
         void addParameter(Application *app, const std::string& name, const std::string& shorthand,
             const std::string& desc, const std::string &expect, const std::string &defValue,
-            ParameterMode parameterMode);
+            ParameterMode parameterMode, bool repeatable = false, bool keyValue = false);
+        void addStaticOption(Application *app, const StaticOption& option);
+        /**
+         * @brief Options with value joined to name, like `-I/usr/include` or `-O2`, keyed by prefix
+         */
+        std::map<std::string, std::shared_ptr<Parameter>> prefixMap = {};
+        void addPrefixParameter(Application *app, const std::string& prefix, const std::string& desc,
+            const std::string &expect, bool repeatable = false, bool separated = false);
+        /**
+         * @brief Options added in bulk, checked by checkPending() and moved to optionMap by mergePending()
+         */
+        std::vector<std::shared_ptr<Option>> pendingOptions = {};
+        void appendOptions(Application *app, const std::vector<StaticOption>& options);
+        /**
+         * @brief Sorts pending options by name and checks them, changes nothing else
+         * @param globals pending global options, sorted, for options of command
+         */
+        void checkPending(Application *app, const std::vector<std::shared_ptr<Option>>& globals);
+        void mergePending();
     };
 
     class Command: public Actual {
         std::string m_desc;
         Action m_handler;
+        CommandFactory m_factory;
+        bool m_argsFrom = false;
+        ItemAction m_itemHandler;
+        int runItems();
+        void materialize();
+        void setMaterializing(bool on);
+        void checkNotFrozen() const;
+        bool convertNumbers();
         [[nodiscard]] std::vector<std::string> preprocessEquals(int start, const std::vector<std::string> &args) const;
         [[nodiscard]] std::vector<std::string> preprocessCompact(int start, const std::vector<std::string> &args) const;
         void parsePreprocessed(int start, const std::vector<std::string> &args);
         void parse(int start, const std::vector<std::string>& args);
         void parseHelpCommand(int start, const std::vector<std::string>& args);
         friend class Application;
+        friend class Category;
+        friend class IncrementalParser;
+        friend class CompletionScriptWriter;
         void printSimilars();
         void printErrors();
         void buildMergedOptions();
+        void buildMergedTree();
         std::set<std::string> hiddenOptNames = {};
+        /**
+         * @brief Nested commands, sorted by token, level of trie walked by Application::dispatch
+         *
+         * Tokens are kept next to pointers, so binary search doesn't touch child commands.
+         */
+        Command* parent = nullptr;
+        std::vector<std::pair<std::string, std::shared_ptr<Command>>> subcommands = {};
+        /**
+         * @brief Names of availableOptionMap, built with it in frozen application,
+         * for abbreviations and completion
+         */
+        PrefixIndex optionIndex;
+        /**
+         * @brief Prefix parameters of this command, ancestors and application, matched by the longest prefix
+         */
+        std::map<std::string, std::shared_ptr<Parameter>> availablePrefixMap = {};
+        PrefixIndex prefixIndex;
+        [[nodiscard]] const Parameter* matchPrefix(const std::string& token) const;
     public:
         Command(std::string name, Application* app): Actual(app, std::move(name)), formal(false) {}
         Formal formal;
         void commandNotFound(const std::string &arg);
+        void invalidUtf8(size_t argIndex, size_t offset);
+        void responseFileCycle(const std::string& path);
+        void ambiguousPrefix(const std::string &arg, std::vector<std::string> candidates);
         json asJson();
         json formalAsJson();
         [[nodiscard]] std::string to_string() const;
         Command& handler(const Action& _handler);
+        /**
+         * @brief Runs action for each variadic argument in parallel, as handler of the command
+         *
+         * Items (with streamed ones, see addArgsFrom) are taken by `--jobs` worker threads
+         * (Application::addJobsOption, hardware concurrency when not given). Output of each item
+         * is buffered and printed in order of items as soon as all earlier ones are done, then freed.
+         * Streamed items are read as workers need them: at most 4 items per worker are waiting
+         * or buffered, so memory doesn't grow with input. Exit code is the first non-zero code
+         * in order of items; exception of action is rethrown after all workers stop. Error of
+         * the stream is reported after items read before it are done.
+         */
+        Command& itemHandler(const ItemAction& action);
         Command& desc(const std::string& _desc);
         Command& addArg(std::string name, std::string type);
         Command& addArgs(std::string name, std::string type, size_t min_n, size_t max_n);
         Command& addArgs(std::string name, std::string type, size_t min_n);
+        /**
+         * @brief Variadic arguments can also come from stream, for lists longer than ARG_MAX
+         *
+         * Adds parameter `--args-from FILE` and flag `--null` (items end with NUL, not newline);
+         * positional `-` means `--args-from -`, standard input. Minimal count of variadic arguments
+         * is not checked when stream is given. Handler reads them by Actual::streamArguments.
+         * Needs addArgs without upper bound.
+         */
+        Command& addArgsFrom();
         Command& addFlag(const std::string& name, const std::string& shorthand,
             const std::string& desc);
         Command& addParameter(const std::string& name, const std::string& shorthand,
@@ -191,6 +465,37 @@ namespace cli
         Command &overrideParameter(const std::string &name, ParameterMode parameterMode,
             const std::string& defValue = "");
         Command &hideOption(const std::string &name);
+        /**
+         * @brief Declares family of gcc-style options with joined value, see Application::addPrefixParameter
+         */
+        Command &addPrefixParameter(const std::string& prefix, const std::string& desc, const std::string &expect,
+            bool repeatable = false, bool separated = false);
+        /**
+         * @brief Parameter which can be repeated, like `-X opt1 -X opt2`, values are read by Actual::getValues
+         */
+        Command &addListParameter(const std::string& name, const std::string& shorthand,
+            const std::string& desc, const std::string &expect);
+        /**
+         * @brief Repeatable parameter of `key=value` pairs, like `-D NAME=VALUE`, read by Actual::getMap
+         *
+         * `key` alone gives empty value, expect is type of value part.
+         */
+        Command &addMapParameter(const std::string& name, const std::string& shorthand,
+            const std::string& desc, const std::string &expect = "string");
+        /**
+         * @brief Adds table of options without per-option checks, see Application::addOptions
+         */
+        Command &addOptions(const std::vector<StaticOption>& options);
+        /**
+         * @brief Adds nested command, as `remote add` in `git remote add`
+         *
+         * Name of the nested command is the whole path ("remote add"), token is its last word.
+         * Options of this command and its ancestors are available in nested one, the nearest
+         * definition wins.
+         */
+        Command& addCommand(const std::string& token);
+        Command& addCommand(const std::string& token, const std::string& desc, CommandFactory factory);
+        std::shared_ptr<Command> findSubcommand(const std::string& token);
         int execute();
         void print() const;
     };
@@ -210,6 +515,29 @@ namespace cli
         Category& operator=(Category&&) = default;
         std::string to_string();
         Command& addCommand(std::string commandName);
+        Command& addCommand(std::string commandName, const std::string& desc, CommandFactory factory);
+    };
+
+    /**
+     * @brief Outcome of one line of Application::parseBatch
+     */
+    struct ParseResult
+    {
+        const Command* command = nullptr; // nullptr when the line names no command
+        int errNumber = 0;
+        std::string errorStr;
+    };
+
+    /**
+     * @brief Commands parsed by one thread, see Application::serve and SchemaOverlay::parse
+     *
+     * Copies of commands are made on first use and reused by the next lines of the thread,
+     * so actual data of threads don't mix.
+     */
+    struct CommandScratch
+    {
+        std::map<const Command*, std::unique_ptr<Command>> copies;
+        std::shared_ptr<Command> error; // command carrying error of routing, which is not a copy
     };
 
     class Application {
@@ -220,9 +548,15 @@ namespace cli
         std::vector<std::unique_ptr<Category>> helpCategories;
         static std::vector<std::string> findMostSimilar(const std::string& proposed, const std::vector<std::string> &keys);
         static std::vector<std::string> splitStringWithQuotes(const std::string& input);
+        static void splitStringWithQuotes(std::string_view input, std::vector<std::string>& tokens, size_t first = 0);
+        friend struct Actual;
         friend class Command;
         friend class Category;
         friend class Formal;
+        friend class IncrementalParser;
+        friend class CompletionScriptWriter;
+        friend class SchemaOverlay;
+        static std::string commandLine(std::string_view name, std::string_view desc);
     public:
         /**
         * @var cmdDepth
@@ -275,11 +609,74 @@ namespace cli
          * The default value is typically 1.
          */
        int helpAvailability;
+        /**
+         * @brief Rejects arguments which are not well-formed UTF-8 before any parsing
+         *
+         * Values:
+         * - 0 – arguments are passed as raw bytes (e.g. for Latin-1 file names)
+         * - 1 (default) – malformed argument gives error InvalidUtf8
+         */
+        int checkUtf8 = 1;
+        /**
+         * @brief Expands response files, as gcc does
+         *
+         * Values:
+         * - 0 (default) – `@name` is ordinary token
+         * - 1 – `@file` is replaced by tokens of the file (mapped, gcc quoting, may nest);
+         *   unreadable file is kept as token, file including itself gives error ResponseFileCycle
+         */
+        int responseFiles = 0;
+        /**
+         * @brief Allows non-ASCII letters in command names
+         *
+         * Values:
+         * - 0 (default) – commands are ASCII identifiers, as `clone` or `init-repo`
+         * - 1 – commands can contain any letters, like `klonuj` or `sklonuj-zdalne`
+         *
+         * Set it before adding commands. Values can use `unicode-identifier` type
+         * independently of this setting.
+         */
+        int unicodeIdentifiers = 0;
+        /**
+         * @brief Accepts unambiguous prefix of command or long option
+         *
+         * Values:
+         * - 0 (default) – names must be given in full
+         * - 1 – `cl` means `clone` and `--verb` means `--verbose`, if nothing else starts so;
+         *   ambiguous prefix gives error AmbiguousPrefix with candidates in mostSimilar
+         *
+         * Takes effect after freeze(), which builds prefix indexes. Nested commands need full names.
+         */
+        int abbreviations = 0;
+        /**
+         * @brief Standard input of streamed arguments (`-`), replaceable for tests
+         */
+        std::istream* argsInput = &std::cin;
     private:
         void printCommands(const Actual* actual) const;
         int commandHelp(Actual* actual);
         [[nodiscard]] std::vector<std::string>  proposeSimilar(const std::string &arg) const;
         static bool findHelpOption(const std::vector<std::string> &args);
+        enum class Route { Parse, Help, Done };
+        /**
+         * @brief Command which parses args from start (how says by which method),
+         * or new Command carrying error of encoding or dispatch
+         */
+        std::shared_ptr<Command> route(const std::vector<std::string> &args, size_t &start, Route &how,
+            const SchemaOverlay* overlay = nullptr);
+        void parseExpanded(const std::vector<std::string> &args);
+        int printCompletions(const std::vector<std::string> &args, const SchemaOverlay* overlay, bool oneShot);
+        /**
+         * @brief Parses args into copy of command kept in scratch, without touching currentCommand,
+         * for schema changed by overlay (when not nullptr)
+         * @return parsed copy, or command carrying error
+         */
+        Command& parseIsolated(const std::vector<std::string>& args, CommandScratch& scratch,
+            const SchemaOverlay* overlay);
+        std::mutex serverMutex;
+        int serverWakeFd = -1;  // write end of pipe which wakes accept loop of serve()
+        bool serverStopped = false;
+        void materializeAll();
         int helpAboutHelp() const;
         /**
          * @brief Locks the definition of global options after commands are created.
@@ -295,7 +692,56 @@ namespace cli
          * global and command-specific options.
          */
         bool globalOptionsLocked = false;
+        /**
+         * @brief Set by freeze(), after it no option, argument or command can be added
+         */
+        bool frozen = false;
+        /**
+         * @brief Image of commands not materialized yet, see loadSnapshot()
+         */
+        std::shared_ptr<const Snapshot> snapshot;
+        void checkNotFrozen() const;
+        /**
+         * @brief Bulk definitions waiting for validatePending()
+         */
+        std::vector<Formal*> pendingFormals;
+        std::vector<std::pair<std::string, std::string>> pendingShorthands; // option name, shorthand
+        std::vector<std::shared_ptr<Command>> pendingCommands;
+        void validatePending();
+        std::shared_ptr<Command> findCommand(const std::string& name);
+        /**
+         * @brief Top-level command named or abbreviated by token, commands hidden by overlay don't count
+         * @param candidates receives names of visible commands when abbreviation is ambiguous
+         */
+        std::shared_ptr<Command> resolveCommand(const std::string& token, std::vector<std::string>& candidates,
+            const SchemaOverlay* overlay);
+        std::shared_ptr<Command> dispatch(const std::vector<std::string>& args, size_t start, size_t& next,
+            std::vector<std::string>& candidates, const SchemaOverlay* overlay = nullptr);
+        /**
+         * @brief Top-level command names (with not materialized ones), for abbreviations and completion,
+         * built by commandNames() of frozen application
+         */
+        PrefixIndex commandIndex;
+        /**
+         * @brief Caption of the first category of each command of commandIndex, empty when none
+         */
+        std::vector<std::string> commandGroups;
+        std::once_flag commandIndexOnce;
+        const PrefixIndex& commandNames();
+        /**
+         * @brief Handlers given by bindHandler() to commands of snapshot not materialized yet
+         */
+        std::map<std::string, Action> handlerBindings;
+        std::shared_ptr<Command> materialize(size_t index);
+        static std::shared_ptr<Option> snapshotOption(const Snapshot& image, const SnapshotOption& rec);
+        [[nodiscard]] std::optional<std::string> resolveShorthand(const std::string& shorthand) const;
+        void printSnapshotCategories(SnapshotCategoryKind kind, const SchemaOverlay* overlay) const;
     protected:
+        /**
+         * @brief Index of command names was built (it is not by freeze() or loadSnapshot())
+         */
+        [[nodiscard]] bool commandIndexBuilt() const { return !commandIndex.empty(); }
+        [[nodiscard]] size_t builtCommandCount() const { return commandMap.size(); }
         int help(Actual*);
         int mainCommandStub(Actual*);
         void initSystemCommands();
@@ -309,14 +755,116 @@ namespace cli
         std::shared_ptr<Command> helpCommand;
         std::shared_ptr<Command> currentCommand;
         int execute();
+        /**
+         * @brief Whole schema as JSON, input for tools/clicmd-gen
+         *
+         * Global options and each command are in the shape of `to_json(Formal)`,
+         * options additionally have "shorthand" when defined. Command has "hidden" options,
+         * "argsFrom" and nested "commands" when present; "categories" and "helpCategories"
+         * list command names of each caption.
+         */
+        [[nodiscard]] json schemaAsJson() const;
         std::shared_ptr<Command> getCommand(const std::string& name);
         void parse(const std::vector<std::string>& args);
         void parse(const std::string& line);
         void parse(int argc, char** argv);
+        /**
+         * @brief Validates many command lines (without program name) on jobs threads
+         *
+         * Freezes the application and defines all lazy commands first, then lines are parsed
+         * in chunks by worker threads, each into its own copies of commands, which are reused
+         * for all lines of that worker. currentCommand and actual data of commands are not changed.
+         * Help lines are accepted without parsing. jobs 0 means hardware concurrency.
+         */
+        std::vector<ParseResult> parseBatch(const std::vector<std::string_view>& lines, unsigned jobs = 0);
+        /**
+         * @brief Parses and executes each line of file (without program name) in order
+         *
+         * File is mapped and split into lines by helper thread, which tokenizes next lines
+         * while current one is executed; token buffers are recycled, commands are parsed
+         * on this thread as by parse(), so handlers see the usual state. Empty lines and
+         * lines starting with `#` are skipped.
+         * @return 0, or exit code of first line which failed (execution stops there)
+         * @throws std::runtime_error if file can't be opened
+         */
+        int runScript(const std::string& path);
+        /**
+         * @brief 1-based number of line executed by runScript() last, 0 before it
+         */
+        size_t scriptLine = 0;
+        /**
+         * @brief Interactive loop: reads line (edited, with history on terminal), parses and executes it
+         *
+         * Lines are without program name, empty ones are skipped, end of input (Ctrl-D) ends the loop.
+         * Line buffer and tokens are reused by all iterations and commands clear their actual data
+         * before each parse, so memory stays flat in long sessions.
+         * @return exit code of the last executed line
+         */
+        int repl(const std::string& prompt = "> ");
+        int repl(LineEditor& editor, const std::string& prompt = "> ");
+        /**
+         * @brief Resident mode: executes command lines sent by forwardCommand() to Unix socket socketPath
+         *
+         * Freezes the application and defines all lazy commands first, so startup cost is paid once.
+         * Requests run on jobs threads (0 means hardware concurrency), each parses into its own
+         * copies of commands, as parseBatch(), so actual data of requests don't mix. What request
+         * writes to std::cout and std::cerr is streamed to its client (output of printf is not),
+         * other threads keep writing to the original streams. Environment and working directory
+         * of client are in currentRequest(). Request fails when its working directory can't be
+         * given to its thread only (it needs Linux). Socket is created accessible only to the owner;
+         * stale socket at socketPath is replaced, other file is not.
+         * @return 0 after stopServing(), when accepted requests are finished
+         * @throws std::runtime_error if socket can't be created or socketPath is not a socket
+         */
+        int serve(const std::string& socketPath, unsigned jobs = 0);
+        /**
+         * @brief Ends serve() running in another thread (or the next one, if none runs yet)
+         */
+        void stopServing();
+        /**
+         * @brief Candidates for word cword of words, as shell gives them (words[0] is program name)
+         *
+         * Freezes the application. Also served by hidden command `__complete <cword> <words...>`,
+         * which prints `value<TAB>description[<TAB>category]` lines and then line `:type`, with
+         * the type of expected value or positional argument (empty when none is expected).
+         */
+        std::vector<CompletionCandidate> complete(const std::vector<std::string>& words, size_t cword,
+            const SchemaOverlay* overlay = nullptr);
+        /**
+         * @brief Values proposed by complete(), cached in `$XDG_CACHE_HOME/<appName>-completion`
+         * (or `~/.cache/...`), see ValueCompleter
+         */
+        ValueCompleter valueCompleter;
+        /**
+         * @brief Self-contained completion script for shell, to be sourced or installed by the user
+         *
+         * Command tree, options, shorthands, types of values and choice sets (Validator::choices)
+         * are written as shell tables with nested case dispatch, so TAB runs no process; paths
+         * are completed by the shell. Materializes all commands and freezes the application.
+         */
+        std::string completionScript(CompletionShell shell);
         int run(int argc, char** argv);
         Category* addCategory(const std::string& caption);
         Category& addHelpCategory(const std::string& caption);
         Command& addCommand(std::string commandName);
+        /**
+         * @brief Registers command stub: name and description only
+         *
+         * Factory adds options and arguments when the command is dispatched, asked for help
+         * or returned by getCommand(), so unused commands cost one map entry. Conflicts of its
+         * shorthands with other commands are reported then, not at registration.
+         */
+        Command& addCommand(std::string commandName, const std::string& desc, CommandFactory factory);
+        /**
+         * @brief Registers commands declared in compile-time schema (see static-schema.h)
+         *
+         * Names were checked by compiler, so commands are added without token checks,
+         * in one pass over table already sorted by name. Commands are stubs, as with factory:
+         * options and arguments are read from the table when the command is dispatched, so
+         * the schema must outlive the application; conflicts with global shorthands are reported then.
+         */
+        template<size_t N> Application& addCommands(const StaticSchema<N>& schema);
+        Application& addStaticCommands(const StaticCommand* staticCommands, size_t count, bool schemaCombineOpts);
         Application &addParameter(const std::string &name, const std::string &shorthand,
             const std::string& desc, const std::string &expect);
         Application &addReqParameter(const std::string &name, const std::string &shorthand,
@@ -324,6 +872,69 @@ namespace cli
         Application &addDefParameter(const std::string &name, const std::string &shorthand,
             const std::string& desc, const std::string &expect, const std::string &defValue);
         Application &addFlag(const std::string &name, const std::string &shorthand, const std::string &desc);
+        /**
+         * @brief Adds global `--jobs`/`-j` integer parameter, number of workers of Command::itemHandler
+         */
+        Application &addJobsOption();
+        /**
+         * @brief Declares family of gcc-style options with value joined to prefix
+         *
+         * Any token starting with prefix and longer than it is the option, rest of token is its value
+         * stored under prefix: `-I/usr/include` for prefix `-I`, `-std=c++17` for `-std=`, `-Wl,-rpath`
+         * for `-Wl,`. The longest declared prefix wins, but option declared by full name, like
+         * `-print-sysroot` against prefix `-p`, is matched first. With separated, prefix given alone
+         * takes the next token as value, as gcc's `-I dir` or `-B dir`; otherwise it is unknown option.
+         */
+        Application &addPrefixParameter(const std::string& prefix, const std::string& desc, const std::string &expect,
+            bool repeatable = false, bool separated = false);
+        Application &addListParameter(const std::string &name, const std::string &shorthand,
+            const std::string& desc, const std::string &expect);
+        Application &addMapParameter(const std::string &name, const std::string &shorthand,
+            const std::string& desc, const std::string &expect = "string");
+        /**
+         * @brief Ends schema definition
+         *
+         * Merged option maps of all commands are built once here instead of on every parse.
+         * Further attempts to add options, arguments, commands or categories throw logic_error.
+         * Handlers can still be set. Calling it again has no effect.
+         */
+        void freeze();
+        [[nodiscard]] bool isFrozen() const { return frozen; }
+        /**
+         * @brief Binary image of frozen schema (freezes application), see snapshot.h
+         *
+         * Handlers are not part of the image, set them after loadSnapshot() with bindHandler().
+         */
+        std::vector<char> snapshotImage();
+        void saveSnapshot(const std::string& path);
+        /**
+         * @brief Uses schema from image instead of registering commands
+         *
+         * Must be called on application without commands and global options, created with the same
+         * cmdDepth and combineOpts. Global options are copied, commands are read from image only
+         * when dispatched or asked for help, so start-up cost does not depend on the schema size.
+         * Application is frozen afterwards.
+         */
+        void loadSnapshot(std::shared_ptr<const Snapshot> image);
+        /**
+         * @brief Sets handler of top-level command by name
+         *
+         * Unlike getCommand()->handler(), command of snapshot is not built: handler waits
+         * until the command is dispatched or asked for. Unknown name throws runtime_error.
+         */
+        Application& bindHandler(const std::string& name, Action handler);
+        /**
+         * @brief Adds table of global options (StaticOption from static-schema.h) without per-option checks
+         *
+         * Syntax, duplicates and shorthand conflicts of all bulk definitions are checked
+         * in one sort-based pass by freeze() or before the first parse, which throws
+         * the same exceptions as addFlag/addParameter would.
+         */
+        Application& addOptions(const std::vector<StaticOption>& options);
+        /**
+         * @brief Adds table of commands with their options and arguments, checked as addOptions
+         */
+        Application& addCommands(const std::vector<StaticCommand>& commandTable);
     };
 
 }
@@ -1,6 +1,16 @@
 #pragma once
 #define INLINE inline
 #include "cli-cmd-impl.hpp"
+#include "completion-impl.hpp"
 #include "distance-impl.hpp"
+#include "line-editor-impl.hpp"
+#include "numeric-impl.hpp"
+#include "overlay-impl.hpp"
+#include "prefix-index-impl.hpp"
+#include "response-file-impl.hpp"
+#include "server-impl.hpp"
+#include "snapshot-impl.hpp"
 #include "util-impl.hpp"
-#include "validator-impl.hpp"
\ No newline at end of file
+#include "utf8-impl.hpp"
+#include "validator-impl.hpp"
+#include "value-map-impl.hpp"
\ No newline at end of file
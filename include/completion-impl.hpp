@@ -0,0 +1,952 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "cli-cmd.h"
+#include "completion.h"
+#include "overlay.h"
+#include "static-schema.h"
+#include "util.h"
+#include "validator.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace cli
+{
+    INLINE IncrementalParser::IncrementalParser(Application& app, const SchemaOverlay* overlay)
+        : m_app(app), m_overlay(overlay)
+    {
+        app.freeze();
+        update("");
+    }
+
+    INLINE IncrementalParser::State IncrementalParser::initial() const
+    {
+        State state;
+        if (m_app.cmdDepth == 0)
+            state.command = m_app.mainCommand.get();
+        return state;
+    }
+
+    INLINE bool IncrementalParser::used(const std::string& name) const
+    {
+        return std::any_of(m_used.begin(), m_used.end(), [&name](const Option* o) { return o->name() == name; });
+    }
+
+    INLINE void IncrementalParser::useOption(State& state, const Option* option)
+    {
+        m_used.resize(state.used);
+        m_used.push_back(option);
+        state.used = static_cast<uint32_t>(m_used.size());
+        if (option->kind() == OptionKind::Parameter)
+            state.parameter = static_cast<const Parameter*>(option);
+    }
+
+    /* the same decisions as Application::route and Command::parsePreprocessed, without errors */
+    INLINE IncrementalParser::State IncrementalParser::advance(State state, std::string_view token)
+    {
+        if (state.unknown)
+            return state;
+        if (state.parameter) {
+            state.parameter = nullptr;
+            return state;
+        }
+        std::string s(token);
+        if (!state.command) {
+            if (!state.help && m_app.helpAvailability > 0 && s == "help") {
+                state.help = true;
+                return state;
+            }
+            std::vector<std::string> candidates;
+            auto command = m_app.resolveCommand(s, candidates, m_overlay);
+            state.command = command.get();
+            state.unknown = !command;
+            return state;
+        }
+        Command* command = state.command;
+        auto lookup = [command](const std::string& name) -> const Option* {
+            auto it = command->availableOptionMap.find(name);
+            return it == command->availableOptionMap.end() ? nullptr : it->second.get();
+        };
+        switch (classifyToken(s, m_app.combineOpts, m_app.unicodeIdentifiers)) {
+            case LongOption:
+            case ShortOption: {
+                if (auto family = command->matchPrefix(s)) {
+                    if (s == family->name())
+                        state.parameter = family; // value is the next token
+                    return state; // value is joined
+                }
+                std::string name = s;
+                if (s.size() == 2) {
+                    auto full = m_app.resolveShorthand(s);
+                    if (full)
+                        name = *full;
+                }
+                if (auto option = lookup(name))
+                    useOption(state, option);
+                return state;
+            }
+            case LongEquals:
+            case ShortEquals: {
+                auto name = splitEquals(s).first;
+                if (name.size() == 2)
+                    if (auto full = m_app.resolveShorthand(name))
+                        name = *full;
+                if (auto option = lookup(name)) {
+                    useOption(state, option);
+                    state.parameter = nullptr; // value is joined
+                }
+                return state;
+            }
+            case CompactFlags:
+            case CompactEquals: {
+                auto letters = splitEquals(s).first;
+                for (size_t i = 1; i < letters.size(); i++)
+                    if (auto full = m_app.resolveShorthand(std::string{'-', letters[i]}))
+                        if (auto option = lookup(*full))
+                            useOption(state, option);
+                if (letters.size() < s.size())
+                    state.parameter = nullptr;
+                return state;
+            }
+            default:
+                break;
+        }
+        if (command->matchPrefix(s))
+            return state;
+        if (state.positional == 0 && !command->subcommands.empty()) {
+            auto sub = command->findSubcommand(s);
+            if (sub && !(m_overlay && m_overlay->hides(sub->m_name))) {
+                state.command = sub.get();
+                return state;
+            }
+        }
+        state.positional++;
+        return state;
+    }
+
+    INLINE const Expectation& IncrementalParser::update(std::string_view line)
+    {
+        // tokens whose end and separator after it are unchanged keep their states
+        size_t common = 0, limit = std::min(line.size(), m_line.size());
+        while (common < limit && line[common] == m_line[common])
+            common++;
+        size_t kept = 0;
+        while (kept < m_tokens.size() && m_tokens[kept].end < common)
+            kept++;
+        m_tokens.resize(kept);
+        m_reused = kept;
+        m_line.assign(line.data(), line.size());
+        State state = kept ? m_tokens.back().after : initial();
+        m_used.resize(state.used);
+
+        auto space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        std::string_view text = m_line;
+        size_t i = kept ? m_tokens.back().end : 0, n = text.size();
+        std::string_view partial;
+        while (true) {
+            while (i < n && space(text[i]))
+                i++;
+            if (i == n)
+                break;
+            size_t start = i;
+            std::string_view token;
+            bool finished;
+            if (text[i] == '"' || text[i] == '\'') {
+                auto end = text.find(text[i], start + 1);
+                finished = end != std::string_view::npos && end + 1 < n;
+                if (end == std::string_view::npos)
+                    end = n;
+                token = text.substr(start + 1, end - start - 1);
+                i = std::min(end + 1, n);
+            } else {
+                while (i < n && !space(text[i]))
+                    i++;
+                token = text.substr(start, i - start);
+                finished = i < n;
+            }
+            if (!finished) {
+                partial = token;
+                break;
+            }
+            state = advance(state, token);
+            m_tokens.push_back(Token{i, state});
+        }
+
+        expect(state, partial);
+        return m_expected;
+    }
+
+    INLINE void IncrementalParser::expect(const State& state, std::string_view partial)
+    {
+        m_expected = Expectation{};
+        m_expected.command = state.command;
+        m_expected.help = state.help;
+        m_expected.partial = partial;
+        m_expected.positional = state.positional;
+        if (state.unknown)
+            m_expected.kind = ExpectKind::Nothing;
+        else if (state.parameter) {
+            m_expected.kind = ExpectKind::Value;
+            m_expected.parameter = state.parameter;
+        } else if (!state.command)
+            m_expected.kind = ExpectKind::Command;
+        else {
+            m_expected.kind = state.help ? ExpectKind::Nothing : ExpectKind::Token;
+            const auto& formal = state.command->formal;
+            if (state.positional < formal.argList.size())
+                m_expected.argument = &formal.argList[state.positional];
+            else if (state.positional - formal.argList.size() < formal.vaArgs.max_n)
+                m_expected.argument = &formal.vaArgs;
+        }
+    }
+
+    INLINE const Expectation& IncrementalParser::assign(const std::string* first, const std::string* last,
+        std::string_view partial)
+    {
+        m_line.clear();
+        m_tokens.clear();
+        m_used.clear();
+        m_reused = 0;
+        State state = initial();
+        for (; first != last; ++first)
+            state = advance(state, *first);
+        expect(state, partial);
+        return m_expected;
+    }
+
+    /* state shared by ValueCompleter and its worker thread, or pipe from its worker process */
+    struct ValueCompleter::Job
+    {
+        int fd = -1; // read end of pipe, values one per line, -1 for worker thread
+        std::string output;
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done = false;
+        Cached result;
+        // set before worker starts, read without lock
+        CompletionSource source;
+        std::string path;
+        std::string key;
+        std::string prefix;
+        int64_t time = 0;
+        std::chrono::milliseconds budget{0};
+        ~Job() {
+#ifndef _WIN32
+            if (fd >= 0)
+                close(fd);
+#endif
+        }
+    };
+
+    INLINE std::string ValueCompleter::cachePath(const std::string& key) const
+    {
+        char name[16];
+        std::snprintf(name, sizeof(name), "%08x", schemaHash(key, 0));
+        return (std::filesystem::path(cacheDir) / name).string();
+    }
+
+    /* file is key line (type, TAB, prefix), time line and values, one per line */
+    INLINE bool ValueCompleter::readCache(const std::string& path, const std::string& key, Cached& cached)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string line;
+        if (!std::getline(in, line) || line != key || !std::getline(in, line))
+            return false;
+        int64_t time;
+        if (!parseInteger(line, time))
+            return false;
+        cached.time = time;
+        cached.values.clear();
+        while (std::getline(in, line))
+            cached.values.push_back(line);
+        return true;
+    }
+
+    INLINE ValueCompleter::Cached ValueCompleter::run(const Job& job)
+    {
+        Cached result{job.time, {}};
+        auto start = std::chrono::steady_clock::now();
+        try {
+            for (auto& value : job.source(job.prefix))
+                if (value.find('\n') == std::string::npos)
+                    result.values.push_back(std::move(value));
+        } catch (...) {
+            // failing source gives no candidates
+        }
+        if (job.path.empty() || std::chrono::steady_clock::now() - start < job.budget)
+            return result;
+        // written aside and renamed, so reader never sees half of file
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(job.path).parent_path(), ec);
+        // unique among processes sharing cacheDir and among threads of this one
+        static std::atomic<uint64_t> temporaryCount{0};
+#ifdef _WIN32
+        auto pid = _getpid();
+#else
+        auto pid = getpid();
+#endif
+        std::ostringstream temporary;
+        temporary << job.path << ".tmp" << pid << '.' << temporaryCount++;
+        {
+            std::ofstream out(temporary.str(), std::ios::binary | std::ios::trunc);
+            out << job.key << '\n' << result.time << '\n';
+            for (const auto& value : result.values)
+                out << value << '\n';
+            if (!out)
+                return result;
+        }
+        std::filesystem::rename(temporary.str(), job.path, ec);
+        if (ec)
+            std::filesystem::remove(temporary.str(), ec);
+        return result;
+    }
+
+    INLINE void ValueCompleter::start(const std::shared_ptr<Job>& job, bool process)
+    {
+#ifndef _WIN32
+        int fds[2];
+        if (process && pipe(fds) == 0) {
+            pid_t child = fork();
+            if (child == 0) {
+                // grandchild is adopted by init, so neither this process nor the shell waits for it
+                if (fork() != 0)
+                    _exit(0);
+                setsid();
+                signal(SIGPIPE, SIG_IGN);
+                close(fds[0]);
+                int null = open("/dev/null", O_RDWR);
+                if (null >= 0) {
+                    dup2(null, STDIN_FILENO);
+                    dup2(null, STDOUT_FILENO);
+                    dup2(null, STDERR_FILENO);
+                }
+                std::string output;
+                for (const auto& value : run(*job).values)
+                    output.append(value).push_back('\n');
+                for (size_t written = 0; written < output.size();) {
+                    auto n = write(fds[1], output.data() + written, output.size() - written);
+                    if (n <= 0)
+                        break;
+                    written += static_cast<size_t>(n);
+                }
+                _exit(0);
+            }
+            close(fds[1]);
+            if (child > 0) {
+                waitpid(child, nullptr, 0);
+                job->fd = fds[0];
+                return;
+            }
+            close(fds[0]);
+        }
+#else
+        (void)process;
+#endif
+        std::thread([job]() {
+            auto result = run(*job);
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->result = std::move(result);
+            job->done = true;
+            job->finished.notify_all();
+        }).detach();
+    }
+
+    /* true when job is done by deadline, then its result is no longer touched by worker */
+    INLINE bool ValueCompleter::finish(Job& job, std::chrono::steady_clock::time_point deadline)
+    {
+#ifndef _WIN32
+        if (job.fd >= 0) {
+            char buffer[4096];
+            for (;;) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                pollfd ready{job.fd, POLLIN, 0};
+                if (poll(&ready, 1, static_cast<int>(std::max<int64_t>(left, 0))) <= 0)
+                    return false;
+                auto n = read(job.fd, buffer, sizeof(buffer));
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                job.output.append(buffer, static_cast<size_t>(n));
+            }
+            close(job.fd);
+            job.fd = -1;
+            job.result.time = job.time;
+            size_t first = 0;
+            for (size_t end; (end = job.output.find('\n', first)) != std::string::npos; first = end + 1)
+                job.result.values.push_back(job.output.substr(first, end - first));
+            job.done = true;
+            return true;
+        }
+#endif
+        std::unique_lock<std::mutex> lock(job.mutex);
+        return job.finished.wait_until(lock, deadline, [&job]() { return job.done; });
+    }
+
+    INLINE std::vector<std::string> ValueCompleter::complete(const std::string& type, const std::string& prefix,
+        bool forkSource)
+    {
+        auto source = ValidatorManager::instance().completionSource(type);
+        if (!source)
+            return {};
+        std::string key = type + '\t' + prefix;
+        if (key.find('\n') != std::string::npos)
+            return {};
+        std::lock_guard<std::mutex> guard(m_mutex);
+        auto now = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        auto fresh = [this, now](const Cached& c) { return now - c.time < ttl.count(); };
+        Cached stale{};
+        auto memory = m_memory.find(key);
+        if (memory != m_memory.end()) {
+            if (fresh(memory->second))
+                return memory->second.values;
+            stale = memory->second;
+        }
+        std::string path = cacheDir.empty() ? std::string() : cachePath(key);
+        Cached stored;
+        if (!path.empty() && readCache(path, key, stored) && stored.time >= stale.time) {
+            m_memory[key] = stored;
+            if (fresh(stored))
+                return stored.values;
+            stale = std::move(stored);
+        }
+        auto& running = m_running[key];
+        if (!running) {
+            running = std::make_shared<Job>();
+            auto job = running;
+            job->source = std::move(source);
+            job->path = std::move(path);
+            job->key = key;
+            job->prefix = prefix;
+            job->time = now;
+            job->budget = budget;
+            start(job, forkSource);
+        }
+        auto job = running;
+        if (!finish(*job, std::chrono::steady_clock::now() + budget))
+            return stale.values;
+        auto values = job->result.values;
+        m_memory[key] = std::move(job->result);
+        m_running.erase(key);
+        return values;
+    }
+
+    INLINE bool ValueCompleter::wait(std::chrono::milliseconds limit)
+    {
+        auto deadline = std::chrono::steady_clock::now() + limit;
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto it = m_running.begin(); it != m_running.end();) {
+            if (!finish(*it->second, deadline))
+                return false;
+            m_memory[it->first] = std::move(it->second->result);
+            it = m_running.erase(it);
+        }
+        return true;
+    }
+
+    INLINE std::vector<CompletionCandidate> IncrementalParser::candidates(bool forkSources) const
+    {
+        std::vector<CompletionCandidate> result;
+        const auto& e = m_expected;
+        auto prefix = e.partial;
+        if (e.kind == ExpectKind::Command) {
+            const auto& index = m_app.commandNames();
+            auto match = index.find(prefix);
+            for (size_t i = match.first; i < match.first + match.count; i++) {
+                const auto& name = index.key(i);
+                if (m_overlay && m_overlay->hides(name))
+                    continue;
+                CompletionCandidate candidate{name, {}, m_app.commandGroups[i]};
+                auto it = m_app.commandMap.find(name);
+                if (it != m_app.commandMap.end())
+                    candidate.description = it->second->m_desc;
+                else if (m_app.snapshot)
+                    if (auto record = m_app.snapshot->findCommand(name))
+                        candidate.description = m_app.snapshot->commandDesc(*record);
+                result.push_back(std::move(candidate));
+            }
+            if (!e.help && m_app.helpAvailability > 0 && std::string_view("help").substr(0, prefix.size()) == prefix) {
+                auto at = std::lower_bound(result.begin(), result.end(), "help",
+                    [](const CompletionCandidate& c, const char* value) { return c.value < value; });
+                result.insert(at, CompletionCandidate{"help", "Show help", {}});
+            }
+            return result;
+        }
+        auto addValues = [this, &result, prefix, forkSources](const std::string& type) {
+            for (auto& value : m_app.valueCompleter.complete(type, std::string(prefix), forkSources))
+                result.push_back(CompletionCandidate{std::move(value), {}, {}});
+        };
+        if (e.kind == ExpectKind::Value)
+            addValues(e.parameter->expectType());
+        if (e.kind != ExpectKind::Token)
+            return result;
+        const Command* command = e.command;
+        if (prefix.empty() || prefix[0] != '-') {
+            if (e.positional == 0)
+                for (auto it = std::lower_bound(command->subcommands.begin(), command->subcommands.end(), prefix,
+                        [](const auto& entry, std::string_view p) { return entry.first < p; });
+                     it != command->subcommands.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+                    if (!m_overlay || !m_overlay->hides(it->second->m_name))
+                        result.push_back(CompletionCandidate{it->first, it->second->m_desc, {}});
+            if (e.argument)
+                addValues(e.argument->expectType());
+            return result;
+        }
+        auto available = [this, command](const std::string& name) -> const Option* {
+            auto it = command->availableOptionMap.find(name);
+            if (it == command->availableOptionMap.end())
+                return nullptr;
+            const Option* option = it->second.get();
+            bool repeatable = option->kind() == OptionKind::Parameter
+                && static_cast<const Parameter*>(option)->repeatable();
+            return repeatable || !used(name) ? option : nullptr;
+        };
+        auto match = command->optionIndex.find(prefix);
+        for (size_t i = match.first; i < match.first + match.count; i++)
+            if (auto option = available(command->optionIndex.key(i)))
+                if (option->name().size() > 2) // short names are listed with shorthands
+                    result.push_back(CompletionCandidate{option->name(), option->description(), {}});
+        match = command->prefixIndex.find(prefix);
+        for (size_t i = match.first; i < match.first + match.count; i++) {
+            const auto& key = command->prefixIndex.key(i);
+            result.push_back(CompletionCandidate{key, command->availablePrefixMap.at(key)->description(), {}});
+        }
+        if (prefix.size() <= 2 && prefix != "--") {
+            // at most one shorthand per letter, so they are looked up, not listed from map
+            auto letter = [&](char c) {
+                std::string shorthand{'-', c};
+                if (prefix.size() == 2 && shorthand != prefix)
+                    return;
+                auto name = m_app.resolveShorthand(shorthand);
+                const Option* option = name ? available(*name) : nullptr;
+                if (option)
+                    result.push_back(CompletionCandidate{shorthand, option->description(), {}});
+            };
+            for (char c = '0'; c <= '9'; c++) letter(c);
+            for (char c = 'A'; c <= 'Z'; c++) letter(c);
+            for (char c = 'a'; c <= 'z'; c++) letter(c);
+        }
+        std::sort(result.begin(), result.end(),
+            [](const CompletionCandidate& a, const CompletionCandidate& b) { return a.value < b.value; });
+        return result;
+    }
+}
+
+namespace cli
+{
+    /* command tree of application as tables of completion script, node 0 is the application */
+    class CompletionScriptWriter
+    {
+        struct Node {
+            std::vector<std::pair<std::string, size_t>> children;       // token of nested command, node
+            std::vector<CompletionCandidate> commands;
+            std::vector<CompletionCandidate> options;
+            std::vector<std::pair<std::string, std::string>> values;    // option taking value, its type
+            std::vector<std::string> arguments;                         // types of positional arguments
+            std::string variadic;                                       // type of the rest, empty when none
+        };
+        Application& m_app;
+        std::string m_name;   // prefix of shell functions
+        std::vector<Node> m_nodes;
+        std::set<std::string> m_types;
+        std::string m_out;
+
+        void addOptions(Node& node, const Command& command) {
+            std::map<std::string, std::string> shorthands; // option name, its shorthand
+            for (char c : std::string("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"))
+                if (auto name = m_app.resolveShorthand(std::string{'-', c}))
+                    shorthands[*name] = std::string{'-', c};
+            for (const auto& [name, option] : command.availableOptionMap) {
+                auto shorthand = shorthands.find(name);
+                std::vector<std::string> spellings{name};
+                if (shorthand != shorthands.end() && shorthand->second != name)
+                    spellings.push_back(shorthand->second);
+                for (const auto& spelling : spellings) {
+                    node.options.push_back(CompletionCandidate{spelling, option->description(), {}});
+                    if (option->kind() == OptionKind::Parameter) {
+                        auto type = static_cast<const Parameter*>(option.get())->expectType();
+                        node.values.emplace_back(spelling, type);
+                        m_types.insert(type);
+                    }
+                }
+            }
+            for (const auto& [prefix, parameter] : command.availablePrefixMap)
+                node.options.push_back(CompletionCandidate{prefix, parameter->description(), {}});
+            std::sort(node.options.begin(), node.options.end(),
+                [](const CompletionCandidate& a, const CompletionCandidate& b) { return a.value < b.value; });
+            for (const auto& argument : command.formal.argList) {
+                node.arguments.push_back(argument.expectType());
+                m_types.insert(argument.expectType());
+            }
+            if (command.formal.vaArgs.max_n > 0) {
+                node.variadic = command.formal.vaArgs.expectType();
+                m_types.insert(node.variadic);
+            }
+        }
+
+        size_t addCommand(const Command& command) {
+            size_t index = m_nodes.size();
+            m_nodes.emplace_back();
+            addOptions(m_nodes[index], command);
+            for (const auto& [token, sub] : command.subcommands) {
+                m_nodes[index].commands.push_back(CompletionCandidate{token, sub->m_desc, {}});
+                size_t child = addCommand(*sub);
+                m_nodes[index].children.emplace_back(token, child);
+            }
+            return index;
+        }
+
+        static bool isPath(const std::string& type) { return type.find("path") != std::string::npos; }
+
+        static std::string quoted(std::string_view s, char quote) {
+            std::string result(1, quote);
+            for (char c : s) {
+                if (quote == '\'' && c == '\'')
+                    result += "'\\''";
+                else {
+                    if (quote == '"' && (c == '"' || c == '\\' || c == '$' || c == '`'))
+                        result += '\\';
+                    result += c;
+                }
+            }
+            return result + quote;
+        }
+
+        /* fish quoting: backslash escapes quote and backslash inside single quotes */
+        static std::string fishQuoted(std::string_view s) {
+            std::string result = "'";
+            for (char c : s) {
+                if (c == '\'' || c == '\\')
+                    result += '\\';
+                result += c;
+            }
+            return result + "'";
+        }
+
+        static std::string joined(const std::vector<std::string>& words) {
+            std::string result;
+            for (const auto& word : words)
+                result += (result.empty() ? "" : " ") + word;
+            return result;
+        }
+
+        /* zsh _describe entry, colon in value must be escaped */
+        static std::string described(const CompletionCandidate& c) {
+            std::string value;
+            for (char ch : c.value)
+                value += ch == ':' ? std::string("\\:") : std::string(1, ch);
+            return quoted(c.description.empty() ? value : value + ":" + c.description, '\'');
+        }
+
+        void line(const std::string& text) { m_out += text; m_out += '\n'; }
+
+        /* tables shared by bash and zsh, same syntax of case */
+        void writePosixTables(bool zsh) {
+            const auto& f = m_name;
+            line(f + "_node() {");
+            line("    case \"$1 $2\" in");
+            for (size_t i = 0; i < m_nodes.size(); i++)
+                for (const auto& [token, child] : m_nodes[i].children)
+                    line("        " + quoted(std::to_string(i) + " " + token, '"') + ") " + f + "_r=" + std::to_string(child) + " ;;");
+            line("        *) " + f + "_r= ;;");
+            line("    esac");
+            line("}");
+            line(f + "_words() {");
+            line("    case $1 in");
+            for (size_t i = 0; i < m_nodes.size(); i++) {
+                std::string commands, options;
+                for (const auto& c : m_nodes[i].commands)
+                    commands += (commands.empty() ? "" : " ") + (zsh ? described(c) : c.value);
+                for (const auto& c : m_nodes[i].options)
+                    options += (options.empty() ? "" : " ") + (zsh ? described(c) : c.value);
+                if (zsh)
+                    line("        " + std::to_string(i) + ") " + f + "_c=(" + commands + ") " + f + "_o=(" + options + ") ;;");
+                else
+                    line("        " + std::to_string(i) + ") " + f + "_c=" + quoted(commands, '"') + " " + f + "_o=" + quoted(options, '"') + " ;;");
+            }
+            line(zsh ? "        *) " + f + "_c=() " + f + "_o=() ;;" : "        *) " + f + "_c= " + f + "_o= ;;");
+            line("    esac");
+            line("}");
+            line(f + "_value() {");
+            line("    case \"$1 $2\" in");
+            for (size_t i = 0; i < m_nodes.size(); i++)
+                for (const auto& [option, type] : m_nodes[i].values)
+                    line("        " + quoted(std::to_string(i) + " " + option, '"') + ") " + f + "_r=" + quoted(type, '"') + " ;;");
+            line("        *) " + f + "_r= ;;");
+            line("    esac");
+            line("}");
+            line(f + "_argument() {");
+            line("    case \"$1 $2\" in");
+            for (size_t i = 0; i < m_nodes.size(); i++) {
+                const auto& node = m_nodes[i];
+                for (size_t k = 0; k < node.arguments.size(); k++)
+                    line("        \"" + std::to_string(i) + " " + std::to_string(k) + "\") " + f + "_r=" + quoted(node.arguments[k], '"') + " ;;");
+                if (!node.variadic.empty())
+                    line("        \"" + std::to_string(i) + " \"*) " + f + "_r=" + quoted(node.variadic, '"') + " ;;");
+            }
+            line("        *) " + f + "_r= ;;");
+            line("    esac");
+            line("}");
+            line("# choices of type, status 1 when values are paths");
+            line(f + "_choices() {");
+            line("    case $1 in");
+            for (const auto& type : m_types) {
+                auto choices = ValidatorManager::instance().choices(type);
+                if (!choices.empty())
+                    line("        " + quoted(type, '"') + ") " + f + "_r=" + quoted(joined(choices), '"') + " ;;");
+                else if (isPath(type))
+                    line("        " + quoted(type, '"') + ") " + f + "_r=; return 1 ;;");
+            }
+            line("        *) " + f + "_r= ;;");
+            line("    esac");
+            line("}");
+        }
+
+        /* walks words before cursor: node, positional index and type of expected value */
+        void writePosixWalk(const std::string& first, const std::string& last, const std::string& word) {
+            const auto& f = m_name;
+            line("    local node=0 pos=0 expect=0 type= i w " + f + "_r " + f + "_c " + f + "_o");
+            line("    for ((i = " + first + "; i < " + last + "; i++)); do");
+            line("        w=" + word);
+            line("        if ((expect)); then expect=0; continue; fi");
+            line("        case $w in");
+            line("            -?*) " + f + "_value $node \"${w%%=*}\"");
+            line("                if [[ -n $" + f + "_r && $w != *=* ]]; then expect=1; type=$" + f + "_r; fi ;;");
+            line("            *) " + f + "_r=");
+            line("                ((pos == 0)) && " + f + "_node $node \"$w\"");
+            line("                if [[ -n $" + f + "_r ]]; then node=$" + f + "_r; else ((pos++)); fi ;;");
+            line("        esac");
+            line("    done");
+            line("    " + f + "_words $node");
+            line("    if ((!expect)); then");
+            line("        type=");
+            line("        if [[ $cur != -* ]]; then " + f + "_argument $node $pos; type=$" + f + "_r; fi");
+            line("    fi");
+        }
+
+        void writeBash() {
+            const auto& f = m_name;
+            line("# bash completion for " + m_app.appName + ", generated from its schema");
+            writePosixTables(false);
+            line(f + "_complete() {");
+            line("    local cur=${COMP_WORDS[COMP_CWORD]}");
+            writePosixWalk("1", "COMP_CWORD", "${COMP_WORDS[i]}");
+            line("    local list=");
+            line("    if ((expect)) || [[ -n $type ]]; then");
+            line("        if " + f + "_choices \"$type\"; then list=$" + f + "_r; else compopt -o filenames -o default 2>/dev/null; fi");
+            line("    fi");
+            line("    if ((!expect)); then");
+            line("        if [[ $cur == -* ]]; then list=$" + f + "_o; elif ((pos == 0)); then list=\"$" + f + "_c $list\"; fi");
+            line("    fi");
+            line("    COMPREPLY=()");
+            line("    for w in $list; do [[ $w == \"$cur\"* ]] && COMPREPLY+=(\"$w\"); done");
+            line("}");
+            line("complete -F " + f + "_complete " + m_app.appName);
+        }
+
+        void writeZsh() {
+            const auto& f = m_name;
+            line("#compdef " + m_app.appName);
+            line("# zsh completion for " + m_app.appName + ", generated from its schema");
+            writePosixTables(true);
+            line(f + "_complete() {");
+            line("    local cur=${words[CURRENT]}");
+            writePosixWalk("2", "CURRENT", "${words[i]}");
+            line("    if ((expect)) || [[ -n $type ]]; then");
+            line("        if " + f + "_choices \"$type\"; then");
+            line("            [[ -n $" + f + "_r ]] && compadd -- ${=" + f + "_r}");
+            line("        else");
+            line("            _files");
+            line("        fi");
+            line("    fi");
+            line("    ((expect)) && return");
+            line("    if [[ $cur == -* ]]; then");
+            line("        _describe -t options option " + f + "_o");
+            line("    elif ((pos == 0)); then");
+            line("        _describe -t commands command " + f + "_c");
+            line("    fi");
+            line("}");
+            line("compdef " + f + "_complete " + m_app.appName);
+        }
+
+        void writeFish() {
+            const auto& f = m_name;
+            line("# fish completion for " + m_app.appName + ", generated from its schema");
+            line("function " + f + "_node --argument-names node word");
+            line("    switch \"$node $word\"");
+            for (size_t i = 0; i < m_nodes.size(); i++)
+                for (const auto& [token, child] : m_nodes[i].children) {
+                    line("        case " + fishQuoted(std::to_string(i) + " " + token));
+                    line("            echo " + std::to_string(child));
+                }
+            line("    end");
+            line("end");
+            auto table = [this, &f](const std::string& function, auto member) {
+                line("function " + f + "_" + function + " --argument-names node");
+                line("    switch $node");
+                for (size_t i = 0; i < m_nodes.size(); i++) {
+                    const auto& candidates = m_nodes[i].*member;
+                    if (candidates.empty())
+                        continue;
+                    line("        case " + std::to_string(i));
+                    for (const auto& c : candidates)
+                        line("            printf '%s\\t%s\\n' " + fishQuoted(c.value) + " " + fishQuoted(c.description));
+                }
+                line("    end");
+                line("end");
+            };
+            table("commands", &Node::commands);
+            table("options", &Node::options);
+            line("function " + f + "_value --argument-names node option");
+            line("    switch \"$node $option\"");
+            for (size_t i = 0; i < m_nodes.size(); i++)
+                for (const auto& [option, type] : m_nodes[i].values) {
+                    line("        case " + fishQuoted(std::to_string(i) + " " + option));
+                    line("            echo " + fishQuoted(type));
+                }
+            line("    end");
+            line("end");
+            line("function " + f + "_argument --argument-names node pos");
+            line("    switch \"$node $pos\"");
+            for (size_t i = 0; i < m_nodes.size(); i++) {
+                const auto& node = m_nodes[i];
+                for (size_t k = 0; k < node.arguments.size(); k++) {
+                    line("        case '" + std::to_string(i) + " " + std::to_string(k) + "'");
+                    line("            echo " + fishQuoted(node.arguments[k]));
+                }
+                if (!node.variadic.empty()) {
+                    line("        case '" + std::to_string(i) + " *'");
+                    line("            echo " + fishQuoted(node.variadic));
+                }
+            }
+            line("    end");
+            line("end");
+            line("# choices of type, status 1 when values are paths");
+            line("function " + f + "_choices --argument-names type");
+            line("    switch $type");
+            for (const auto& type : m_types) {
+                auto choices = ValidatorManager::instance().choices(type);
+                if (!choices.empty()) {
+                    line("        case " + fishQuoted(type));
+                    std::string values;
+                    for (const auto& choice : choices)
+                        values += " " + fishQuoted(choice);
+                    line("            printf '%s\\n'" + values);
+                } else if (isPath(type)) {
+                    line("        case " + fishQuoted(type));
+                    line("            return 1");
+                }
+            }
+            line("    end");
+            line("end");
+            line("function " + f + "_complete");
+            line("    set -l words (commandline -opc)");
+            line("    set -l cur (commandline -ct)");
+            line("    set -l node 0");
+            line("    set -l pos 0");
+            line("    set -l expect 0");
+            line("    set -l type");
+            line("    for w in $words[2..-1]");
+            line("        if test $expect = 1");
+            line("            set expect 0");
+            line("            continue");
+            line("        end");
+            line("        switch $w");
+            line("            case '-?*'");
+            line("                set -l t (" + f + "_value $node (string split -m1 = -- $w)[1])");
+            line("                if test -n \"$t\"; and not string match -q -- '*=*' $w");
+            line("                    set expect 1");
+            line("                    set type $t");
+            line("                end");
+            line("            case '*'");
+            line("                set -l next");
+            line("                test $pos = 0; and set next (" + f + "_node $node $w)");
+            line("                if test -n \"$next\"");
+            line("                    set node $next");
+            line("                else");
+            line("                    set pos (math $pos + 1)");
+            line("                end");
+            line("        end");
+            line("    end");
+            line("    if test $expect = 0");
+            line("        if string match -q -- '-*' $cur");
+            line("            " + f + "_options $node");
+            line("            return");
+            line("        end");
+            line("        test $pos = 0; and " + f + "_commands $node");
+            line("        set type (" + f + "_argument $node $pos)");
+            line("    end");
+            line("    if test -n \"$type\"");
+            line("        " + f + "_choices $type; or __fish_complete_path $cur");
+            line("    end");
+            line("end");
+            line("complete -c " + m_app.appName + " -f -a '(" + f + "_complete)'");
+        }
+
+    public:
+        explicit CompletionScriptWriter(Application& app): m_app(app) {
+            m_name = "_";
+            for (char c : app.appName)
+                m_name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+            app.freeze();
+            app.materializeAll();
+            if (app.cmdDepth == 0) {
+                addCommand(*app.mainCommand);
+                return;
+            }
+            m_nodes.emplace_back();
+            for (const auto& [name, command] : app.commandMap) {
+                m_nodes[0].commands.push_back(CompletionCandidate{name, command->m_desc, {}});
+                size_t child = addCommand(*command);
+                m_nodes[0].children.emplace_back(name, child);
+            }
+            if (app.helpAvailability > 0) {
+                // `help` is followed by path of command, as the application itself
+                size_t help = m_nodes.size();
+                m_nodes.emplace_back();
+                m_nodes[help].children = m_nodes[0].children;
+                m_nodes[help].commands = m_nodes[0].commands;
+                m_nodes[0].commands.push_back(CompletionCandidate{"help", "Show help", {}});
+                m_nodes[0].children.emplace_back("help", help);
+                std::sort(m_nodes[0].commands.begin(), m_nodes[0].commands.end(),
+                    [](const CompletionCandidate& a, const CompletionCandidate& b) { return a.value < b.value; });
+            }
+        }
+
+        std::string script(CompletionShell shell) {
+            m_out.clear();
+            switch (shell) {
+                case CompletionShell::Bash: writeBash(); break;
+                case CompletionShell::Zsh: writeZsh(); break;
+                case CompletionShell::Fish: writeFish(); break;
+            }
+            return m_out;
+        }
+    };
+
+    INLINE std::string Application::completionScript(CompletionShell shell)
+    {
+        return CompletionScriptWriter(*this).script(shell);
+    }
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli
+{
+    class Application;
+    class Command;
+    class Option;
+    class Parameter;
+    class Argument;
+    class SchemaOverlay;
+
+    enum class ExpectKind {
+        Command,   // name of command, nothing dispatched yet
+        Token,     // option, positional argument or nested command of dispatched command
+        Value,     // value of parameter given by the previous token
+        Nothing    // line names unknown command, nothing can follow
+    };
+
+    /**
+     * @brief What the token at the end of line can be
+     */
+    struct Expectation
+    {
+        ExpectKind kind = ExpectKind::Command;
+        const Command* command = nullptr;     // dispatched command, nullptr before it
+        const Parameter* parameter = nullptr; // parameter waiting for its value
+        const Argument* argument = nullptr;   // formal of the next positional, nullptr when no more fit
+        size_t positional = 0;                // index of the next positional argument
+        bool help = false;                    // line started with `help`
+        std::string_view partial;             // unfinished last token (unquoted), empty after space
+    };
+
+    enum class CompletionShell { Bash, Zsh, Fish };
+
+    /**
+     * @brief Completion of the token under cursor, see IncrementalParser::candidates
+     */
+    struct CompletionCandidate
+    {
+        std::string value;
+        std::string description;
+        std::string group;       // category caption of command, empty for other candidates
+    };
+
+    /**
+     * @brief Candidate values of types (ValidatorManager::completionSource), computed on background thread
+     *
+     * complete() waits for the source at most budget. Results are kept in memory and, from sources
+     * slower than budget, in cacheDir, keyed by type and prefix, until they are older than ttl. Source slower than budget keeps
+     * running: complete() returns stale cached values (or none) and a later call gets the fresh
+     * ones. Workers own their data, so they can outlive the completer (and the application).
+     * Empty cacheDir keeps results only in memory. With forkSource, source runs in detached
+     * process instead of thread, so slow one finishes (and fills the cache) after a one-shot
+     * process as `__complete` exits.
+     */
+    class ValueCompleter
+    {
+        struct Job;
+        struct Cached {
+            int64_t time;     // seconds since epoch
+            std::vector<std::string> values;
+        };
+        std::map<std::string, Cached> m_memory;
+        std::map<std::string, std::shared_ptr<Job>> m_running;
+        mutable std::mutex m_mutex; // requests of Application::serve complete concurrently
+        [[nodiscard]] std::string cachePath(const std::string& key) const;
+        static bool readCache(const std::string& path, const std::string& key, Cached& cached);
+        static Cached run(const Job& job);
+        static void start(const std::shared_ptr<Job>& job, bool process);
+        static bool finish(Job& job, std::chrono::steady_clock::time_point deadline);
+    public:
+        std::string cacheDir;
+        std::chrono::milliseconds budget{100};
+        std::chrono::seconds ttl{60};
+        /**
+         * @brief Values of type starting with prefix, empty when type has no source
+         * @param forkSource new source runs in forked process (POSIX); only when the process has
+         * no other thread, as fork copies just the calling one
+         */
+        std::vector<std::string> complete(const std::string& type, const std::string& prefix,
+            bool forkSource = false);
+        /**
+         * @brief Waits for sources still running, at most limit; true when none is left
+         */
+        bool wait(std::chrono::milliseconds limit);
+        [[nodiscard]] bool pending() const {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return !m_running.empty();
+        }
+    };
+
+    /**
+     * @brief Parser of line being edited, for completion and hints
+     *
+     * Keeps state after each finished token (dispatched command, used options, parameter
+     * waiting for value, positional index). update() compares new line with the previous one
+     * and re-tokenizes only from the first changed byte, so typing at the end of line costs
+     * the edited suffix, not the whole line. Tokens are split as by Application::parse(line),
+     * errors are not reported: unknown options are skipped, as the user is still typing.
+     *
+     * Freezes the application; lazy commands are materialized when the line dispatches them.
+     */
+    class IncrementalParser
+    {
+        struct State {
+            Command* command = nullptr;
+            const Parameter* parameter = nullptr;
+            uint32_t positional = 0;
+            uint32_t used = 0; // size of m_used
+            bool help = false;
+            bool unknown = false;
+        };
+        struct Token {
+            size_t end;        // offset after token, the byte there is separator or next token
+            State after;
+        };
+        Application& m_app;
+        const SchemaOverlay* m_overlay;
+        std::string m_line;
+        std::vector<Token> m_tokens;      // finished tokens
+        std::vector<const Option*> m_used; // options in order of line, truncated with tokens
+        Expectation m_expected;
+        size_t m_reused = 0;
+        [[nodiscard]] State initial() const;
+        State advance(State state, std::string_view token);
+        void useOption(State& state, const Option* option);
+        void expect(const State& state, std::string_view partial);
+    public:
+        /**
+         * @param overlay when not nullptr, commands it hides are neither dispatched nor proposed
+         */
+        explicit IncrementalParser(Application& app, const SchemaOverlay* overlay = nullptr);
+        /**
+         * @brief Sets edited line (without program name), returns expectation at its end
+         */
+        const Expectation& update(std::string_view line);
+        /**
+         * @brief Sets tokens already split (as by shell), partial is the token under cursor
+         *
+         * Views of expected() point to partial, it must outlive them. The next update() parses
+         * its line from the start.
+         */
+        const Expectation& assign(const std::string* first, const std::string* last, std::string_view partial);
+        [[nodiscard]] const Expectation& expected() const { return m_expected; }
+        /**
+         * @brief Names which can replace expected().partial
+         *
+         * Commands (with `help`) before dispatch; nested commands of the dispatched one; its options
+         * and shorthands not used yet (repeatable ones always) when partial starts with `-`.
+         * Names come from prefix indexes (built by freeze(), command names by the first lookup),
+         * so cost depends on the number of candidates, not on the size of schema; they are sorted. Values of parameter or
+         * positional argument follow, from Application::valueCompleter, see ValueCompleter::complete
+         * for forkSources.
+         */
+        [[nodiscard]] std::vector<CompletionCandidate> candidates(bool forkSources = false) const;
+        /**
+         * @brief Option (by full name) was already given in the line
+         */
+        [[nodiscard]] bool used(const std::string& name) const;
+        /**
+         * @brief Number of finished tokens kept by the last update, not parsed again
+         */
+        [[nodiscard]] size_t reusedTokens() const { return m_reused; }
+        [[nodiscard]] const std::string& line() const { return m_line; }
+    };
+}
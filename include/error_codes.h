@@ -15,6 +15,11 @@ namespace cli::ErrorCode {
     inline constexpr int IsNotExpectedTypeArg    = 11;
     inline constexpr int IsNotExpectedTypeParam  = 12;
     inline constexpr int BadArgumentParsing      = 13;
+    inline constexpr int InvalidUtf8             = 14;
+    inline constexpr int AmbiguousPrefix         = 15;
+    inline constexpr int BadKeyValue             = 16;
+    inline constexpr int ArgsSourceUnreadable    = 17;
+    inline constexpr int ResponseFileCycle       = 18;
 
 } // namespace cli::ErrorCode
 
@@ -62,6 +67,21 @@ namespace cli::ErrorMessage {
     inline constexpr const char* BadArgumentParsing =
             "error: bad argument parsing for '%s'";
 
+    inline constexpr const char* InvalidUtf8 =
+            "error: argument %d is not valid UTF-8 (byte %d)";
+
+    inline constexpr const char* AmbiguousPrefix =
+            "error: `%s' is ambiguous";
+
+    inline constexpr const char* BadKeyValue =
+            "error: `%s' is not key=value pair for param `%s'";
+
+    inline constexpr const char* ArgsSourceUnreadable =
+            "error: cannot read arguments from `%s'";
+
+    inline constexpr const char* ResponseFileCycle =
+            "error: response file `%s' includes itself";
+
 } // namespace cli::ErrorMessage
 
 namespace cli {
@@ -0,0 +1,199 @@
+#pragma once
+#include "line-editor.h"
+
+#ifndef _WIN32
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace cli
+{
+    INLINE bool LineEditor::isContinuation(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+
+    INLINE size_t LineEditor::columns(std::string_view s)
+    {
+        size_t n = 0;
+        for (char c : s)
+            n += !isContinuation(c);
+        return n;
+    }
+
+    INLINE LineEditor::LineEditor(std::istream& in, std::ostream& out, size_t historySize)
+        : m_in(in), m_out(out), m_editing(false), m_historySize(historySize)
+    {
+#ifndef _WIN32
+        m_editing = &in == &std::cin && isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+#endif
+    }
+
+    INLINE void LineEditor::addHistory(std::string_view line)
+    {
+        if (line.empty() || m_historySize == 0 || (!m_history.empty() && m_history.back() == line))
+            return;
+        if (m_history.size() == m_historySize) {
+            // oldest entry is recycled, so full history doesn't allocate
+            auto oldest = std::move(m_history.front());
+            m_history.pop_front();
+            oldest.assign(line.data(), line.size());
+            m_history.push_back(std::move(oldest));
+        } else
+            m_history.emplace_back(line);
+    }
+
+    INLINE bool LineEditor::readLine(std::string_view prompt, std::string& line)
+    {
+        line.clear();
+        if (m_editing)
+            return editLine(prompt, line);
+        if (!std::getline(m_in, line))
+            return false;
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        return true;
+    }
+
+    INLINE void LineEditor::refresh(std::string_view prompt, const std::string& line, size_t pos)
+    {
+        m_screen.assign("\r");
+        m_screen.append(prompt);
+        m_screen.append(line);
+        m_screen.append("\x1b[0K\r");
+        size_t column = columns(prompt) + columns(std::string_view(line).substr(0, pos));
+        if (column > 0)
+            m_screen.append("\x1b[").append(std::to_string(column)).append("C");
+        m_out << m_screen << std::flush;
+    }
+
+    INLINE bool LineEditor::editLine(std::string_view prompt, std::string& line)
+    {
+#ifndef _WIN32
+        // raw mode of standard input for time of one line, handlers run in normal mode
+        struct RawTerminal {
+            termios saved{};
+            bool active = false;
+            explicit RawTerminal(bool terminal) {
+                if (!terminal || tcgetattr(STDIN_FILENO, &saved) != 0)
+                    return;
+                termios raw = saved;
+                raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+                raw.c_cflag |= CS8;
+                raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+                raw.c_cc[VMIN] = 1;
+                raw.c_cc[VTIME] = 0;
+                active = tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+            }
+            ~RawTerminal() {
+                if (active)
+                    tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+            }
+        } raw(&m_in == &std::cin && isatty(STDIN_FILENO));
+#endif
+        size_t pos = 0;
+        size_t recalled = m_history.size(); // index of shown history entry, size() is the edited line
+        std::string edited;
+        auto left = [&line](size_t p) {
+            while (p > 0 && isContinuation(line[--p])) {}
+            return p;
+        };
+        auto right = [&line](size_t p) {
+            while (p < line.size() && isContinuation(line[++p])) {}
+            return std::min(p, line.size());
+        };
+        auto recall = [&](size_t index) {
+            if (recalled == m_history.size())
+                edited = line;
+            recalled = index;
+            line = recalled == m_history.size() ? edited : m_history[recalled];
+            pos = line.size();
+        };
+        refresh(prompt, line, pos);
+        while (true) {
+            int c = m_in.get();
+            if (c == std::char_traits<char>::eof()) {
+                m_out << "\n" << std::flush;
+                return !line.empty();
+            }
+            switch (c) {
+                case '\r': case '\n':
+                    m_out << "\n" << std::flush;
+                    return true;
+                case 3: // Ctrl-C
+                    m_out << "^C\n" << std::flush;
+                    line.clear();
+                    return true;
+                case 4: // Ctrl-D
+                    if (line.empty()) {
+                        m_out << "\n" << std::flush;
+                        return false;
+                    }
+                    if (pos < line.size())
+                        line.erase(pos, right(pos) - pos);
+                    break;
+                case 127: case 8: // Backspace
+                    if (pos > 0) {
+                        size_t p = left(pos);
+                        line.erase(p, pos - p);
+                        pos = p;
+                    }
+                    break;
+                case 1: pos = 0; break;               // Ctrl-A
+                case 5: pos = line.size(); break;     // Ctrl-E
+                case 2: pos = left(pos); break;       // Ctrl-B
+                case 6: pos = right(pos); break;      // Ctrl-F
+                case 11: line.erase(pos); break;      // Ctrl-K
+                case 12: m_out << "\x1b[H\x1b[2J"; break; // Ctrl-L
+                case 21:                              // Ctrl-U
+                    line.erase(0, pos);
+                    pos = 0;
+                    break;
+                case 23: {                            // Ctrl-W
+                    size_t p = pos;
+                    while (p > 0 && line[p - 1] == ' ')
+                        p--;
+                    while (p > 0 && line[p - 1] != ' ')
+                        p--;
+                    line.erase(p, pos - p);
+                    pos = p;
+                    break;
+                }
+                case 27: { // escape sequence
+                    int c1 = m_in.get();
+                    int c2 = m_in.get();
+                    if (c1 != '[' && c1 != 'O')
+                        break;
+                    if (c2 >= '0' && c2 <= '9') {
+                        if (m_in.get() != '~')
+                            break;
+                        if (c2 == '3' && pos < line.size())
+                            line.erase(pos, right(pos) - pos);
+                        else if (c2 == '1' || c2 == '7')
+                            pos = 0;
+                        else if (c2 == '4' || c2 == '8')
+                            pos = line.size();
+                        break;
+                    }
+                    switch (c2) {
+                        case 'A': if (recalled > 0) recall(recalled - 1); break;
+                        case 'B': if (recalled < m_history.size()) recall(recalled + 1); break;
+                        case 'C': pos = right(pos); break;
+                        case 'D': pos = left(pos); break;
+                        case 'H': pos = 0; break;
+                        case 'F': pos = line.size(); break;
+                        default: break;
+                    }
+                    break;
+                }
+                default:
+                    if (c >= 32) {
+                        line.insert(pos, 1, static_cast<char>(c));
+                        pos++;
+                    }
+                    break;
+            }
+            refresh(prompt, line, pos);
+        }
+    }
+}
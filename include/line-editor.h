@@ -0,0 +1,47 @@
+#pragma once
+#include <deque>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace cli
+{
+    /**
+     * @brief Minimal line editor with history, no dependencies beyond POSIX termios
+     *
+     * On terminal, keys are read in raw mode: arrows, Home/End, Backspace/Delete, history
+     * (Up/Down) and Emacs keys Ctrl-A/E/B/F/K/U/W/L; Ctrl-C drops the line, Ctrl-D on empty
+     * line ends input. Line is redrawn with one write per key. Other streams are read by lines,
+     * unless editing is forced.
+     */
+    class LineEditor
+    {
+        std::istream& m_in;
+        std::ostream& m_out;
+        bool m_editing;
+        size_t m_historySize;
+        std::deque<std::string> m_history;
+        std::string m_screen; // redraw buffer, reused
+        static bool isContinuation(char c);
+        static size_t columns(std::string_view s);
+        void refresh(std::string_view prompt, const std::string& line, size_t pos);
+        bool editLine(std::string_view prompt, std::string& line);
+    public:
+        explicit LineEditor(std::istream& in = std::cin, std::ostream& out = std::cout, size_t historySize = 1000);
+        /**
+         * @brief Reads one line into line (its capacity is reused)
+         * @return false at end of input
+         */
+        bool readLine(std::string_view prompt, std::string& line);
+        /**
+         * @brief Appends line to history, except empty one and repetition of the last one
+         */
+        void addHistory(std::string_view line);
+        [[nodiscard]] const std::deque<std::string>& history() const { return m_history; }
+        [[nodiscard]] bool editing() const { return m_editing; }
+        /**
+         * @brief Reads keys from the stream also when it is not terminal (scripted sessions, tests)
+         */
+        void forceEditing(bool on) { m_editing = on; }
+    };
+}
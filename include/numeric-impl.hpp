@@ -0,0 +1,127 @@
+#pragma once
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+#include "numeric.h"
+#include "utf8.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLICMD_NUMERIC_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CLICMD_NUMERIC_NEON
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define CLICMD_NUMERIC_SWAR
+#endif
+
+namespace cli
+{
+    INLINE NumericKind numericKind(const std::string& expectType) {
+        if (expectType == "integer")
+            return NumericKind::Integer;
+        if (expectType == "decimal")
+            return NumericKind::Decimal;
+        if (expectType == "float" || expectType == "number")
+            return NumericKind::Float;
+        return NumericKind::None;
+    }
+
+    INLINE size_t digitPrefixLength(const char* data, size_t len) {
+        size_t i = 0;
+#if defined(CLICMD_NUMERIC_SSE2)
+        // signed compare after shifting '0' to -128, digits are the ten smallest values
+        const __m128i shift = _mm_set1_epi8(static_cast<char>(0x80 - '0'));
+        const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 10));
+        for (; i + 16 <= len; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i digits = _mm_cmplt_epi8(_mm_add_epi8(block, shift), limit);
+            int mask = _mm_movemask_epi8(digits) ^ 0xFFFF;
+            if (mask != 0)
+                return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+#elif defined(CLICMD_NUMERIC_NEON)
+        for (; i + 16 <= len; i += 16) {
+            uint8x16_t block = vsubq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)), vdupq_n_u8('0'));
+            if (vmaxvq_u8(block) > 9)
+                break;
+        }
+#endif
+        while (i < len && isAsciiDigit(data[i]))
+            i++;
+        return i;
+    }
+
+    /* value of eight ASCII digits */
+    INLINE uint64_t parseEightDigits(const char* data) {
+#if defined(CLICMD_NUMERIC_SWAR)
+        uint64_t v;
+        std::memcpy(&v, data, 8);
+        v = ((v & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+        v = ((v & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+        return ((v & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+#else
+        uint64_t v = 0;
+        for (int k = 0; k < 8; k++)
+            v = v * 10 + static_cast<uint64_t>(data[k] - '0');
+        return v;
+#endif
+    }
+
+    INLINE bool parseInteger(std::string_view s, int64_t& value) {
+        bool negative = !s.empty() && s[0] == '-';
+        const char* p = s.data() + negative;
+        size_t n = s.size() - negative;
+        if (n == 0 || digitPrefixLength(p, n) != n)
+            return false;
+        if (p[0] == '0')
+            return n == 1 && !negative; // no leading zeros and no -0
+        if (n > 19)
+            return false;
+        uint64_t magnitude = 0;
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+            magnitude = magnitude * 100000000 + parseEightDigits(p + i);
+        for (; i < n; i++)
+            magnitude = magnitude * 10 + static_cast<uint64_t>(p[i] - '0');
+        // 19 digits fit into uint64_t, range of int64_t is checked here
+        auto max = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+        if (magnitude > max + negative)
+            return false;
+        value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+        return true;
+    }
+
+    INLINE bool parseFloat(std::string_view s, bool exponent, double& value) {
+        size_t i = 0, n = s.size();
+        if (n == 0)
+            return false;
+        if (s[i] == '+' || s[i] == '-')
+            i++;
+        size_t start = s[0] == '+' ? 1 : 0; // from_chars doesn't take '+'
+        size_t digits = digitPrefixLength(s.data() + i, n - i);
+        if (digits == 0 || (digits > 1 && s[i] == '0'))
+            return false;
+        i += digits;
+        if (i < n && s[i] == '.') {
+            i++;
+            i += digitPrefixLength(s.data() + i, n - i); // `1.` is allowed
+        }
+        if (exponent && i < n && (s[i] == 'e' || s[i] == 'E')) {
+            i++;
+            if (i < n && (s[i] == '+' || s[i] == '-'))
+                i++;
+            size_t expDigits = digitPrefixLength(s.data() + i, n - i);
+            if (expDigits == 0)
+                return false;
+            i += expDigits;
+        }
+        if (i != n)
+            return false;
+        auto [end, ec] = std::from_chars(s.data() + start, s.data() + n, value);
+        return ec == std::errc() && end == s.data() + n;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace cli
+{
+    /**
+     * @brief Numeric validator types which variadic arguments are converted for
+     *
+     * `integer` gives int64_t, `decimal`, `float` and `number` give double.
+     */
+    enum class NumericKind { None, Integer, Decimal, Float };
+
+    NumericKind numericKind(const std::string& expectType);
+
+    /**
+     * @brief Length of run of ASCII digits at the start of data
+     *
+     * Checked 16 bytes at a time with SSE2 (x86-64) or NEON (aarch64), scalar elsewhere.
+     */
+    size_t digitPrefixLength(const char* data, size_t len);
+
+    /**
+     * @brief Parses token of IntegerValidator grammar, `0|-?[1-9][0-9]*`, false also on overflow
+     *
+     * Digits are converted eight at a time in one 64-bit word (SWAR) on little-endian targets.
+     */
+    bool parseInteger(std::string_view s, int64_t& value);
+
+    /**
+     * @brief Parses token of FloatValidator grammar (DecimalValidator one without exponent)
+     *
+     * Grammar is checked with digitPrefixLength, conversion is std::from_chars.
+     */
+    bool parseFloat(std::string_view s, bool exponent, double& value);
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+
+#include "cli-cmd.h"
+#include "overlay.h"
+#include "util.h"
+#include "validator.h"
+
+namespace cli
+{
+    INLINE SchemaOverlay::SchemaOverlay(Application& base): m_base(base)
+    {
+        // after this, routing only reads the schema and can run in parallel
+        base.freeze();
+        base.materializeAll();
+    }
+
+    INLINE const Command& SchemaOverlay::baseCommand(const std::string& name) const
+    {
+        std::shared_ptr<Command> command;
+        size_t first = 0;
+        while (first <= name.size()) {
+            auto end = std::min(name.find(' ', first), name.size());
+            auto token = name.substr(first, end - first);
+            command = command ? command->findSubcommand(token) : m_base.findCommand(token);
+            if (!command)
+                break;
+            first = end + 1;
+        }
+        if (!command)
+            throw std::invalid_argument(fmt("command '%s' doesn't exist", name.c_str()));
+        return *command;
+    }
+
+    INLINE const Parameter& SchemaOverlay::baseParameter(const Command& command, const std::string& name)
+    {
+        auto it = command.availableOptionMap.find(name);
+        auto parameter = it == command.availableOptionMap.end() ? nullptr : dynamic_cast<const Parameter*>(it->second.get());
+        if (!parameter)
+            throw std::invalid_argument(fmt("parameter '%s' doesn't exist", name.c_str()));
+        return *parameter;
+    }
+
+    INLINE SchemaOverlay& SchemaOverlay::hideCommand(const std::string& name)
+    {
+        (void)baseCommand(name);
+        m_hidden.insert(name);
+        return *this;
+    }
+
+    INLINE SchemaOverlay& SchemaOverlay::setDefault(const std::string& command, const std::string& parameter,
+        const std::string& value)
+    {
+        const Parameter* formal;
+        if (command.empty()) {
+            auto it = m_base.formal.optionMap.find(parameter);
+            formal = it == m_base.formal.optionMap.end() ? nullptr : dynamic_cast<const Parameter*>(it->second.get());
+            if (!formal)
+                throw std::invalid_argument(fmt("global parameter '%s' doesn't exist", parameter.c_str()));
+        } else
+            formal = &baseParameter(baseCommand(command), parameter);
+        std::string found;
+        if (!ValidatorManager::instance().validate(value, formal->expectType(), found)
+                && !extraChoice(command, parameter, value))
+            throw std::invalid_argument(fmt("default value '%s' is not of type '%s'",
+                value.c_str(), formal->expectType().c_str()));
+        m_defaults[command][parameter] = value;
+        return *this;
+    }
+
+    INLINE SchemaOverlay& SchemaOverlay::addChoices(const std::string& command, const std::string& name,
+        const std::vector<std::string>& values)
+    {
+        const auto& base = baseCommand(command);
+        bool argument = name == base.formal.vaArgs.name() && base.formal.vaArgs.max_n > 0;
+        for (const auto& formal : base.formal.argList)
+            argument = argument || formal.name() == name;
+        if (!argument)
+            (void)baseParameter(base, name);
+        auto& choices = m_choices[command][name];
+        choices.insert(choices.end(), values.begin(), values.end());
+        std::sort(choices.begin(), choices.end());
+        choices.erase(std::unique(choices.begin(), choices.end()), choices.end());
+        return *this;
+    }
+
+    INLINE bool SchemaOverlay::hides(std::string_view name) const
+    {
+        if (m_hidden.empty())
+            return false;
+        for (size_t end = name.find(' '); end != std::string_view::npos; end = name.find(' ', end + 1))
+            if (m_hidden.count(std::string(name.substr(0, end))))
+                return true;
+        return m_hidden.count(std::string(name)) > 0;
+    }
+
+    INLINE const std::string* SchemaOverlay::defaultValue(const std::string& command, const std::string& parameter) const
+    {
+        auto find = [this, &parameter](const std::string& scope) -> const std::string* {
+            auto values = m_defaults.find(scope);
+            if (values == m_defaults.end())
+                return nullptr;
+            auto it = values->second.find(parameter);
+            return it == values->second.end() ? nullptr : &it->second;
+        };
+        if (auto value = find(command))
+            return value;
+        return find(std::string());
+    }
+
+    INLINE bool SchemaOverlay::extraChoice(const std::string& command, const std::string& name, std::string_view value) const
+    {
+        auto names = m_choices.find(command);
+        if (names == m_choices.end())
+            return false;
+        auto it = names->second.find(name);
+        return it != names->second.end() && std::binary_search(it->second.begin(), it->second.end(), value);
+    }
+
+    INLINE Command& SchemaOverlay::parse(const std::vector<std::string>& args, CommandScratch& scratch) const
+    {
+        return m_base.parseIsolated(args, scratch, this);
+    }
+}
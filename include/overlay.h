@@ -0,0 +1,73 @@
+#pragma once
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cli-cmd.h"
+
+namespace cli
+{
+    /**
+     * @brief Variant of schema of base application, keeping only its differences (copy-on-write)
+     *
+     *     cli::SchemaOverlay tenant(app);
+     *     tenant.hideCommand("gc").setDefault("clone", "--depth", "1").addChoices("push", "remote", {"mirror"});
+     *     ...
+     *     thread_local cli::CommandScratch scratch;
+     *     int code = tenant.parse(args, scratch).execute();
+     *
+     * Base is frozen (with all lazy commands defined) by the first overlay and is never changed,
+     * so any number of overlays share its commands and option maps. Parsing goes through the base
+     * schema, overlay is consulted only where it differs: hidden commands are unknown (also to help),
+     * changed default is used when the parameter is not given, extra choices are accepted besides
+     * values of the type. Overlay is read-only while parsing, so threads can parse with it
+     * concurrently, each into its own scratch; handlers see the overlay in Actual::overlay.
+     */
+    class SchemaOverlay
+    {
+        Application& m_base;
+        std::set<std::string> m_hidden;
+        // command name ("" for global options of all commands), option name, value
+        std::map<std::string, std::map<std::string, std::string>> m_defaults;
+        // command name, parameter or argument name, sorted values
+        std::map<std::string, std::map<std::string, std::vector<std::string>>> m_choices;
+        [[nodiscard]] const Command& baseCommand(const std::string& name) const;
+        [[nodiscard]] static const Parameter& baseParameter(const Command& command, const std::string& name);
+    public:
+        explicit SchemaOverlay(Application& base);
+        [[nodiscard]] Application& base() const { return m_base; }
+        /**
+         * @brief Makes command (with its nested ones) unknown, name is full path as "remote add"
+         * @throws std::invalid_argument if base has no such command
+         */
+        SchemaOverlay& hideCommand(const std::string& name);
+        /**
+         * @brief Value of parameter of command when it is not given, also for required one
+         *
+         * Empty command sets default of global parameter for all commands, default of command wins.
+         * @throws std::invalid_argument if command or parameter doesn't exist or value is not of its type
+         */
+        SchemaOverlay& setDefault(const std::string& command, const std::string& parameter, const std::string& value);
+        /**
+         * @brief Accepts values for parameter or positional argument name of command, besides values of its type
+         * @throws std::invalid_argument if command has no such parameter or argument
+         */
+        SchemaOverlay& addChoices(const std::string& command, const std::string& name, const std::vector<std::string>& values);
+        /**
+         * @brief Command name or any command it is nested in is hidden
+         */
+        [[nodiscard]] bool hides(std::string_view name) const;
+        /**
+         * @brief Default set for parameter of command, nullptr when base default applies
+         */
+        [[nodiscard]] const std::string* defaultValue(const std::string& command, const std::string& parameter) const;
+        [[nodiscard]] bool extraChoice(const std::string& command, const std::string& name, std::string_view value) const;
+        /**
+         * @brief Parses args (with program name) into copy of command kept in scratch
+         * @return command to execute, with actual data or error
+         */
+        Command& parse(const std::vector<std::string>& args, CommandScratch& scratch) const;
+    };
+}
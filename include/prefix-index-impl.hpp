@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "prefix-index.h"
+
+namespace cli
+{
+    INLINE PrefixIndex::PrefixIndex(std::vector<std::string> keys): m_keys(std::move(keys))
+    {
+        std::sort(m_keys.begin(), m_keys.end());
+        m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+        if (m_keys.size() >= std::numeric_limits<uint32_t>::max())
+            throw std::length_error("too many keys for prefix index");
+        auto n = static_cast<uint32_t>(m_keys.size());
+        m_nodes.push_back(Node{0, n, 0, 0, 0});
+        if (n > 0)
+            build(0, 0, n, 0);
+    }
+
+    /* keys [lo, hi) share first depth characters */
+    INLINE void PrefixIndex::build(uint32_t node, uint32_t lo, uint32_t hi, size_t depth)
+    {
+        uint32_t i = lo;
+        if (m_keys[i].size() == depth)
+            i++; // key ending in this node sorts first
+        std::vector<std::pair<uint32_t, uint32_t>> groups;
+        while (i < hi) {
+            char c = m_keys[i][depth];
+            uint32_t j = i + 1;
+            while (j < hi && m_keys[j][depth] == c)
+                j++;
+            groups.emplace_back(i, j);
+            i = j;
+        }
+        auto firstChild = static_cast<uint32_t>(m_nodes.size());
+        m_nodes[node].firstChild = firstChild;
+        m_nodes[node].childCount = static_cast<uint32_t>(groups.size());
+        m_nodes.resize(m_nodes.size() + groups.size());
+        for (size_t k = 0; k < groups.size(); k++) {
+            auto [a, b] = groups[k];
+            // common prefix of sorted range is common prefix of its first and last key
+            const auto& x = m_keys[a];
+            const auto& y = m_keys[b - 1];
+            size_t end = depth + 1;
+            while (end < x.size() && end < y.size() && x[end] == y[end])
+                end++;
+            m_nodes[firstChild + k] = Node{a, b - a, static_cast<uint32_t>(end), 0, 0};
+            build(static_cast<uint32_t>(firstChild + k), a, b, end);
+        }
+    }
+
+    /* child of node at given depth whose edge starts with c, or UINT32_MAX */
+    INLINE uint32_t PrefixIndex::child(uint32_t node, size_t depth, char c) const
+    {
+        const Node& n = m_nodes[node];
+        auto edgeChar = [this, depth](uint32_t k) {
+            return static_cast<unsigned char>(m_keys[m_nodes[k].first][depth]);
+        };
+        uint32_t lo = n.firstChild, hi = n.firstChild + n.childCount;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (edgeChar(mid) < static_cast<unsigned char>(c))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == n.firstChild + n.childCount || edgeChar(lo) != static_cast<unsigned char>(c))
+            return std::numeric_limits<uint32_t>::max();
+        return lo;
+    }
+
+    INLINE PrefixIndex::Match PrefixIndex::find(std::string_view prefix) const
+    {
+        if (m_keys.empty())
+            return {};
+        uint32_t node = 0;
+        size_t depth = 0;
+        while (depth < prefix.size()) {
+            uint32_t next = child(node, depth, prefix[depth]);
+            if (next == std::numeric_limits<uint32_t>::max())
+                return {};
+            const auto& label = m_keys[m_nodes[next].first];
+            size_t end = std::min<size_t>(m_nodes[next].edgeEnd, prefix.size());
+            for (size_t k = depth + 1; k < end; k++)
+                if (label[k] != prefix[k])
+                    return {};
+            node = next;
+            depth = m_nodes[next].edgeEnd;
+        }
+        const Node& n = m_nodes[node];
+        return {n.first, n.count, m_keys[n.first].size() == prefix.size()};
+    }
+
+    INLINE const std::string* PrefixIndex::longestMatch(std::string_view text) const
+    {
+        if (m_keys.empty())
+            return nullptr;
+        const std::string* best = nullptr;
+        uint32_t node = 0;
+        size_t depth = 0;
+        while (true) {
+            const auto& first = m_keys[m_nodes[node].first];
+            if (first.size() == depth)
+                best = &first;
+            if (depth >= text.size())
+                break;
+            uint32_t next = child(node, depth, text[depth]);
+            if (next == std::numeric_limits<uint32_t>::max() || m_nodes[next].edgeEnd > text.size())
+                break;
+            const auto& label = m_keys[m_nodes[next].first];
+            if (label.compare(depth + 1, m_nodes[next].edgeEnd - depth - 1, text, depth + 1,
+                    m_nodes[next].edgeEnd - depth - 1) != 0)
+                break;
+            node = next;
+            depth = m_nodes[next].edgeEnd;
+        }
+        return best;
+    }
+
+    INLINE const std::string* PrefixIndex::resolve(std::string_view prefix, std::vector<std::string>& candidates) const
+    {
+        auto match = find(prefix);
+        if (match.exact || match.count == 1)
+            return &m_keys[match.first];
+        candidates.assign(m_keys.begin() + match.first, m_keys.begin() + match.first + match.count);
+        return nullptr;
+    }
+}
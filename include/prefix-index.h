@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli
+{
+    /**
+     * @brief Radix tree over set of names, resolves unique-prefix abbreviations
+     *
+     * Keys of any subtree are contiguous in sorted order, so node keeps only range
+     * of keys and its size. Edge labels are not copied, they are ranges of the first
+     * key in subtree. Lookup walks at most prefix length characters and never scans keys.
+     */
+    class PrefixIndex
+    {
+        struct Node {
+            uint32_t first;      // keys in subtree, its first key also labels the edge
+            uint32_t count;
+            uint32_t edgeEnd;    // edge into node is [depth of parent, edgeEnd) of key `first`
+            uint32_t firstChild; // children are contiguous, sorted by first character
+            uint32_t childCount;
+        };
+        std::vector<std::string> m_keys;
+        std::vector<Node> m_nodes;
+        void build(uint32_t node, uint32_t lo, uint32_t hi, size_t depth);
+        [[nodiscard]] uint32_t child(uint32_t node, size_t depth, char c) const;
+    public:
+        struct Match {
+            size_t first = 0;
+            size_t count = 0;
+            bool exact = false; // prefix is itself key, at position first
+        };
+        PrefixIndex() = default;
+        explicit PrefixIndex(std::vector<std::string> keys);
+        [[nodiscard]] Match find(std::string_view prefix) const;
+        /**
+         * @brief Key equal to prefix or the only key starting with it, otherwise nullptr
+         * @param candidates receives all keys starting with prefix when there is more than one
+         */
+        [[nodiscard]] const std::string* resolve(std::string_view prefix, std::vector<std::string>& candidates) const;
+        /**
+         * @brief The longest key which is prefix of text, e.g. `-Wl,` for `-Wl,-rpath`, or nullptr
+         */
+        [[nodiscard]] const std::string* longestMatch(std::string_view text) const;
+        [[nodiscard]] bool empty() const { return m_keys.empty(); }
+        [[nodiscard]] size_t size() const { return m_keys.size(); }
+        [[nodiscard]] const std::string& key(size_t index) const { return m_keys[index]; }
+    };
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+
+#include "response-file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cli
+{
+    INLINE std::unique_ptr<MappedFile> MappedFile::open(const std::string& path)
+    {
+        std::unique_ptr<MappedFile> file(new MappedFile());
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return nullptr;
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return nullptr;
+        }
+        file->m_size = static_cast<size_t>(st.st_size);
+        if (file->m_size > 0) { // empty file can't be mapped
+            void* mapping = mmap(nullptr, file->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                return nullptr;
+            }
+            file->m_mapping = mapping;
+            file->m_data = static_cast<const char*>(mapping);
+        }
+        ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return nullptr;
+        file->m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        file->m_data = file->m_buffer.data();
+        file->m_size = file->m_buffer.size();
+#endif
+        return file;
+    }
+
+    INLINE MappedFile::~MappedFile()
+    {
+#ifndef _WIN32
+        if (m_mapping)
+            munmap(m_mapping, m_size);
+#endif
+    }
+
+    INLINE void splitResponseFile(std::string_view text, std::vector<std::string_view>& tokens, std::string& scratch)
+    {
+        scratch.clear();
+        scratch.reserve(text.size());
+        size_t i = 0, n = text.size();
+        auto space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+        while (i < n) {
+            while (i < n && space(text[i]))
+                i++;
+            if (i == n)
+                break;
+            size_t start = i;
+            while (i < n && !space(text[i]) && text[i] != '\'' && text[i] != '"' && text[i] != '\\')
+                i++;
+            if (i == n || space(text[i])) {
+                tokens.push_back(text.substr(start, i - start)); // plain token, view into file
+                continue;
+            }
+            // token with quotes or escapes, unescaped into scratch
+            size_t first = scratch.size();
+            scratch.append(text.data() + start, i - start);
+            char quote = 0;
+            for (; i < n; i++) {
+                char c = text[i];
+                if (c == '\\' && i + 1 < n) {
+                    scratch += text[++i];
+                } else if (quote) {
+                    if (c == quote)
+                        quote = 0;
+                    else
+                        scratch += c;
+                } else if (c == '\'' || c == '"') {
+                    quote = c;
+                } else if (space(c)) {
+                    break;
+                } else if (c != '\\') {
+                    scratch += c;
+                }
+            }
+            tokens.emplace_back(scratch.data() + first, scratch.size() - first);
+        }
+    }
+
+    /* files in stack are being expanded, their canonical paths detect cycles */
+    INLINE bool expandResponseFile(const std::string& path, std::vector<std::string>& expanded,
+        std::vector<std::string>& stack, std::string& cycle)
+    {
+        std::error_code ec;
+        auto canonical = std::filesystem::canonical(path, ec).string();
+        auto file = ec ? nullptr : MappedFile::open(path);
+        if (!file)
+            return false;
+        for (const auto& open : stack)
+            if (open == canonical) {
+                cycle = path;
+                return true;
+            }
+        stack.push_back(canonical);
+        std::vector<std::string_view> tokens;
+        std::string scratch;
+        splitResponseFile(file->view(), tokens, scratch);
+        for (auto token : tokens) {
+            if (token.size() > 1 && token[0] == '@') {
+                std::string nested(token.substr(1));
+                if (expandResponseFile(nested, expanded, stack, cycle)) {
+                    if (!cycle.empty())
+                        return true;
+                    continue;
+                }
+            }
+            expanded.emplace_back(token);
+        }
+        stack.pop_back();
+        return true;
+    }
+
+    INLINE std::string expandResponseFiles(const std::vector<std::string>& args, std::vector<std::string>& expanded)
+    {
+        std::vector<std::string> stack;
+        std::string cycle;
+        for (size_t i = 0; i < args.size(); i++) {
+            if (i > 0 && args[i].size() > 1 && args[i][0] == '@'
+                    && expandResponseFile(args[i].substr(1), expanded, stack, cycle)) {
+                if (!cycle.empty())
+                    return cycle;
+                continue;
+            }
+            expanded.push_back(args[i]);
+        }
+        return {};
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli
+{
+    /**
+     * @brief Read-only file mapped into memory (read into buffer on platforms without mmap)
+     */
+    class MappedFile
+    {
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_mapping = nullptr;
+        std::vector<char> m_buffer;
+        MappedFile() = default;
+    public:
+        /**
+         * @brief nullptr if file can't be opened or mapped
+         */
+        static std::unique_ptr<MappedFile> open(const std::string& path);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+        [[nodiscard]] const char* data() const { return m_data; }
+        [[nodiscard]] size_t size() const { return m_size; }
+        [[nodiscard]] std::string_view view() const { return {m_data, m_size}; }
+    };
+
+    /**
+     * @brief Splits content of response file with gcc (libiberty buildargv) rules
+     *
+     * Tokens are separated by whitespace, single and double quotes group, backslash
+     * escapes the next character everywhere. Token without quotes or backslashes is view
+     * into text, other ones are unescaped into scratch, which is reserved once to text size
+     * and never reallocates, so all views stay valid while text and scratch live.
+     */
+    void splitResponseFile(std::string_view text, std::vector<std::string_view>& tokens, std::string& scratch);
+
+    /**
+     * @brief Replaces `@file` tokens (except args[0]) with tokens of file, recursively
+     *
+     * As in gcc, `@file` which can't be opened is kept as it is.
+     * @return empty string or path of response file which includes itself
+     */
+    std::string expandResponseFiles(const std::vector<std::string>& args, std::vector<std::string>& expanded);
+}
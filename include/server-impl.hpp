@@ -0,0 +1,405 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "cli-cmd.h"
+#include "server.h"
+#include "util.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+extern char** environ;
+#endif
+
+namespace cli
+{
+    INLINE const ServerRequest* currentRequest()
+    {
+        return threadRequest;
+    }
+
+    INLINE const char* ServerRequest::getenv(std::string_view name) const
+    {
+        for (const auto& entry : env)
+            if (entry.size() > name.size() && entry[name.size()] == '=' && entry.compare(0, name.size(), name) == 0)
+                return entry.c_str() + name.size() + 1;
+        return nullptr;
+    }
+
+    INLINE std::streambuf* ThreadStreamRouter::target() const
+    {
+        auto* own = threadStreamTargets[m_slot];
+        return own ? own : m_fallback;
+    }
+
+    INLINE ThreadStreamRouter::int_type ThreadStreamRouter::overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        return target()->sputc(traits_type::to_char_type(c));
+    }
+
+    INLINE std::streamsize ThreadStreamRouter::xsputn(const char* s, std::streamsize n)
+    {
+        return target()->sputn(s, n);
+    }
+
+    INLINE int ThreadStreamRouter::sync()
+    {
+        return target()->pubsync();
+    }
+
+#ifndef _WIN32
+    /* whole buffer or false, without SIGPIPE when peer is gone */
+    INLINE bool socketWrite(int fd, const void* data, size_t size)
+    {
+        auto* p = static_cast<const char*>(data);
+        while (size > 0) {
+#ifdef MSG_NOSIGNAL
+            ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+#else
+            ssize_t n = ::write(fd, p, size);
+#endif
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    INLINE bool socketRead(int fd, void* data, size_t size)
+    {
+        auto* p = static_cast<char*>(data);
+        while (size > 0) {
+            ssize_t n = ::read(fd, p, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    INLINE void appendStrings(std::string& out, const std::vector<std::string>& strings)
+    {
+        auto appendSize = [&out](size_t size) {
+            auto value = static_cast<uint32_t>(size);
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        appendSize(strings.size());
+        for (const auto& s : strings) {
+            appendSize(s.size());
+            out += s;
+        }
+    }
+
+    /* limits keep broken or hostile request from allocating without bound */
+    INLINE bool readStrings(int fd, std::vector<std::string>& strings)
+    {
+        constexpr uint32_t MaxCount = 1 << 20, MaxSize = 1 << 24;
+        uint32_t count;
+        if (!socketRead(fd, &count, sizeof(count)) || count > MaxCount)
+            return false;
+        strings.resize(count);
+        for (auto& s : strings) {
+            uint32_t size;
+            if (!socketRead(fd, &size, sizeof(size)) || size > MaxSize)
+                return false;
+            s.resize(size);
+            if (size > 0 && !socketRead(fd, s.data(), size))
+                return false;
+        }
+        return true;
+    }
+
+    INLINE bool writeFrame(int fd, ServerChannel channel, const char* data, size_t size)
+    {
+        char header[5];
+        header[0] = static_cast<char>(channel);
+        auto size32 = static_cast<uint32_t>(size);
+        std::memcpy(header + 1, &size32, sizeof(size32));
+        return socketWrite(fd, header, sizeof(header)) && socketWrite(fd, data, size);
+    }
+
+    INLINE sockaddr_un socketAddress(const std::string& path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path))
+            throw std::invalid_argument(fmt("socket path '%s' is empty or too long", path.c_str()));
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    INLINE ServerStreamBuf::ServerStreamBuf(int fd, ServerChannel channel): m_fd(fd), m_channel(channel)
+    {
+        setp(m_buffer, m_buffer + sizeof(m_buffer));
+    }
+
+    INLINE bool ServerStreamBuf::send()
+    {
+        size_t size = pptr() - pbase();
+        if (size > 0 && !m_broken)
+            m_broken = !writeFrame(m_fd, m_channel, pbase(), size);
+        setp(m_buffer, m_buffer + sizeof(m_buffer));
+        return !m_broken;
+    }
+
+    INLINE ServerStreamBuf::int_type ServerStreamBuf::overflow(int_type c)
+    {
+        send();
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+            sputc(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+
+    INLINE int ServerStreamBuf::sync()
+    {
+        send();
+        return 0;
+    }
+
+    INLINE int forwardCommand(const std::string& socketPath, const std::vector<std::string>& args, int outFd, int errFd)
+    {
+        auto address = socketAddress(socketPath);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            if (fd >= 0)
+                ::close(fd);
+            throw std::runtime_error(fmt("can't connect to server '%s'", socketPath.c_str()));
+        }
+        std::vector<std::string> env;
+        for (char** e = environ; *e; e++)
+            env.emplace_back(*e);
+        std::string cwd(4096, '\0');
+        if (!::getcwd(cwd.data(), cwd.size()))
+            cwd.clear();
+        cwd.resize(std::strlen(cwd.c_str()));
+        // one write, server reads request before it runs anything
+        std::string request(ServerMagic, sizeof(ServerMagic));
+        appendStrings(request, args);
+        appendStrings(request, env);
+        appendStrings(request, {cwd});
+        int code = 255;
+        std::vector<char> data;
+        if (socketWrite(fd, request.data(), request.size()))
+            for (;;) {
+                char header[5];
+                uint32_t size;
+                if (!socketRead(fd, header, sizeof(header)))
+                    break;
+                std::memcpy(&size, header + 1, sizeof(size));
+                data.resize(size);
+                if (size > 0 && !socketRead(fd, data.data(), size))
+                    break;
+                auto channel = static_cast<ServerChannel>(header[0]);
+                if (channel == ServerChannel::Exit) {
+                    int32_t exitCode;
+                    if (size == sizeof(exitCode)) {
+                        std::memcpy(&exitCode, data.data(), sizeof(exitCode));
+                        code = exitCode;
+                    }
+                    break;
+                }
+                int target = channel == ServerChannel::Err ? errFd : outFd;
+                for (size_t done = 0; done < size;) {
+                    ssize_t n = ::write(target, data.data() + done, size - done);
+                    if (n < 0 && errno == EINTR)
+                        continue;
+                    if (n <= 0)
+                        break;
+                    done += static_cast<size_t>(n);
+                }
+            }
+        ::close(fd);
+        return code;
+    }
+#else
+    INLINE int forwardCommand(const std::string& socketPath, const std::vector<std::string>&, int, int)
+    {
+        throw std::runtime_error(fmt("can't connect to server '%s'", socketPath.c_str()));
+    }
+#endif
+
+    INLINE void Application::stopServing()
+    {
+        std::lock_guard<std::mutex> lock(serverMutex);
+#ifndef _WIN32
+        if (serverWakeFd >= 0) {
+            char byte = 0;
+            (void)!::write(serverWakeFd, &byte, 1);
+        }
+#endif
+        serverStopped = true;
+    }
+
+#ifndef _WIN32
+    INLINE int Application::serve(const std::string& socketPath, unsigned jobs)
+    {
+        auto address = socketAddress(socketPath);
+        // after this, routing only reads the schema and can run in parallel
+        freeze();
+        materializeAll();
+        struct stat existing{};
+        if (::lstat(socketPath.c_str(), &existing) == 0) {
+            if (!S_ISSOCK(existing.st_mode))
+                throw std::runtime_error(fmt("'%s' exists and is not a socket", socketPath.c_str()));
+            ::unlink(socketPath.c_str()); // stale socket of server which was killed
+        }
+        int wake[2];
+        if (::pipe(wake) != 0)
+            throw std::runtime_error("can't create pipe");
+        int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        // socket is created accessible only to the owner, no window with permissions of umask
+        mode_t mask = ::umask(S_IRWXG | S_IRWXO);
+        bool bound = listener >= 0 && ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        ::umask(mask);
+        if (!bound || ::listen(listener, SOMAXCONN) != 0) {
+            if (listener >= 0)
+                ::close(listener);
+            ::close(wake[0]);
+            ::close(wake[1]);
+            throw std::runtime_error(fmt("can't listen on '%s'", socketPath.c_str()));
+        }
+        {
+            std::lock_guard<std::mutex> lock(serverMutex);
+            serverWakeFd = wake[1];
+            if (serverStopped) {
+                char byte = 0;
+                (void)!::write(wake[1], &byte, 1);
+            }
+        }
+
+        ThreadStreamRouter outRouter(std::cout.rdbuf(), 0), errRouter(std::cerr.rdbuf(), 1);
+        std::cout.flush();
+        std::cerr.flush();
+        std::cout.rdbuf(&outRouter);
+        std::cerr.rdbuf(&errRouter);
+
+        std::deque<int> queue;
+        bool closing = false;
+        std::mutex mutex;
+        std::condition_variable changed;
+        auto work = [this, &queue, &closing, &mutex, &changed]() {
+#ifdef __linux__
+            // own working directory, so chdir of request doesn't move other workers
+            bool ownDirectory = ::unshare(CLONE_FS) == 0;
+#else
+            bool ownDirectory = false;
+#endif
+            CommandScratch scratch;
+            ServerRequest request;
+            for (;;) {
+                int fd;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [&]() { return !queue.empty() || closing; });
+                    if (queue.empty())
+                        return;
+                    fd = queue.front();
+                    queue.pop_front();
+                }
+                char magic[sizeof(ServerMagic)];
+                std::vector<std::string> cwd;
+                if (!socketRead(fd, magic, sizeof(magic)) || std::memcmp(magic, ServerMagic, sizeof(magic)) != 0
+                        || !readStrings(fd, request.args) || !readStrings(fd, request.env)
+                        || !readStrings(fd, cwd) || cwd.size() != 1) {
+                    ::close(fd);
+                    continue;
+                }
+                request.cwd = std::move(cwd[0]);
+                if (request.args.empty())
+                    request.args.push_back(appName);
+                ServerStreamBuf out(fd, ServerChannel::Out), err(fd, ServerChannel::Err);
+                threadStreamTargets[0] = &out;
+                threadStreamTargets[1] = &err;
+                threadRequest = &request;
+                int32_t code;
+                if (!request.cwd.empty() && (!ownDirectory || ::chdir(request.cwd.c_str()) != 0)) {
+                    // running in directory of other request or of server would be silently wrong
+                    std::cerr << "error: can't change directory to " << request.cwd << std::endl;
+                    code = 1;
+                } else
+                    try {
+                        code = parseIsolated(request.args, scratch, nullptr).execute();
+                    } catch (const std::exception& e) {
+                        std::cerr << "error: " << e.what() << std::endl;
+                        code = 1;
+                    }
+                std::cout.flush();
+                std::cerr.flush();
+                threadRequest = nullptr;
+                threadStreamTargets[0] = nullptr;
+                threadStreamTargets[1] = nullptr;
+                writeFrame(fd, ServerChannel::Exit, reinterpret_cast<const char*>(&code), sizeof(code));
+                ::close(fd);
+            }
+        };
+        if (jobs == 0)
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+        for (unsigned w = 0; w < jobs; w++)
+            workers.emplace_back(work);
+
+        pollfd fds[2] = {{listener, POLLIN, 0}, {wake[0], POLLIN, 0}};
+        for (;;) {
+            if (::poll(fds, 2, -1) < 0 && errno != EINTR)
+                break;
+            if (fds[1].revents)
+                break;
+            if (fds[0].revents & POLLIN) {
+                int fd = ::accept(listener, nullptr, nullptr);
+                if (fd < 0)
+                    continue;
+                std::lock_guard<std::mutex> lock(mutex);
+                queue.push_back(fd);
+                changed.notify_one();
+            }
+        }
+        ::close(listener);
+        ::unlink(socketPath.c_str());
+        {
+            // accepted requests are finished
+            std::lock_guard<std::mutex> lock(mutex);
+            closing = true;
+            changed.notify_all();
+        }
+        for (auto& worker : workers)
+            worker.join();
+        std::cout.rdbuf(outRouter.fallback());
+        std::cerr.rdbuf(errRouter.fallback());
+        {
+            std::lock_guard<std::mutex> lock(serverMutex);
+            serverWakeFd = -1;
+            serverStopped = false;
+        }
+        ::close(wake[0]);
+        ::close(wake[1]);
+        return 0;
+    }
+#else
+    INLINE int Application::serve(const std::string&, unsigned)
+    {
+        throw std::runtime_error("serve is not supported on this platform");
+    }
+#endif
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli
+{
+    /*
+     * Protocol of Application::serve, over stream socket, integers in native byte order:
+     *
+     *   request:  magic | args | env | cwd           each list is u32 count, then u32 size + bytes per string
+     *   response: frames { u8 channel, u32 size, bytes }, last one is ServerChannel::Exit with i32 code
+     */
+    constexpr char ServerMagic[4] = {'C', 'L', 'S', '1'};
+
+    enum class ServerChannel : uint8_t { Exit = 0, Out = 1, Err = 2 };
+
+    /**
+     * @brief Command line of client, as seen by handler running in Application::serve
+     */
+    struct ServerRequest
+    {
+        std::vector<std::string> args;  // with program name
+        std::vector<std::string> env;   // `NAME=value`
+        std::string cwd;
+        /**
+         * @brief Value of environment variable of client, nullptr when not set
+         */
+        [[nodiscard]] const char* getenv(std::string_view name) const;
+    };
+
+    /**
+     * @brief Request executed on this thread by Application::serve, nullptr outside of it
+     *
+     * Server process has its own environment, handlers which depend on it read client's one here.
+     * On Linux each worker has its own working directory, changed to cwd of request,
+     * elsewhere relative paths have to be resolved against cwd by handler.
+     */
+    const ServerRequest* currentRequest();
+
+    /*
+     * Per-thread state of Application::serve. Namespace-scope inline variables are one entity in the
+     * whole program, also when the library is built from sources and headers at the same time.
+     */
+    inline thread_local const ServerRequest* threadRequest = nullptr;
+    inline thread_local std::streambuf* threadStreamTargets[2] = {nullptr, nullptr};
+
+    /**
+     * @brief Client shim: runs args (with program name) in server listening on socketPath,
+     * with environment and working directory of this process
+     *
+     * Output of the command is copied to outFd and errFd as it comes. Standard input is not forwarded.
+     * @return exit code of command, 255 when server closed connection before it
+     * @throws std::runtime_error if server can't be reached, so caller can run the command itself
+     */
+    int forwardCommand(const std::string& socketPath, const std::vector<std::string>& args, int outFd = 1, int errFd = 2);
+
+    /**
+     * @brief Buffer of std::cout or std::cerr while serving: writes of worker thread go to stream
+     * of its request (threadStreamTargets, by slot: 0 for std::cout, 1 for std::cerr),
+     * writes of other threads to the original buffer
+     */
+    class ThreadStreamRouter : public std::streambuf
+    {
+        std::streambuf* m_fallback;
+        size_t m_slot;
+        [[nodiscard]] std::streambuf* target() const;
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+        int sync() override;
+    public:
+        ThreadStreamRouter(std::streambuf* fallback, size_t slot): m_fallback(fallback), m_slot(slot) {}
+        [[nodiscard]] std::streambuf* fallback() const { return m_fallback; }
+    };
+
+    /**
+     * @brief Output of request, sent as frames of channel when buffer is full or on flush
+     *
+     * When client is gone, output is dropped and command runs to its end.
+     */
+    class ServerStreamBuf : public std::streambuf
+    {
+        int m_fd;
+        ServerChannel m_channel;
+        bool m_broken = false;
+        char m_buffer[4096];
+        bool send();
+    protected:
+        int_type overflow(int_type c) override;
+        int sync() override;
+    public:
+        ServerStreamBuf(int fd, ServerChannel channel);
+    };
+}
@@ -0,0 +1,523 @@
+#pragma once
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+#include "cli-cmd.h"
+#include "overlay.h"
+#include "response-file.h"
+#include "snapshot.h"
+
+namespace cli
+{
+    INLINE std::shared_ptr<const Snapshot> Snapshot::open(const std::string& path)
+    {
+        std::shared_ptr<Snapshot> snapshot(new Snapshot());
+        snapshot->m_file = MappedFile::open(path);
+        if (!snapshot->m_file)
+            throw std::runtime_error("can't open snapshot " + path);
+        if (snapshot->m_file->size() < sizeof(SnapshotHeader))
+            throw std::runtime_error("snapshot " + path + " is too small");
+        snapshot->m_data = snapshot->m_file->data();
+        snapshot->m_size = snapshot->m_file->size();
+        snapshot->validate();
+        return snapshot;
+    }
+
+    INLINE std::shared_ptr<const Snapshot> Snapshot::fromBytes(std::vector<char> bytes)
+    {
+        std::shared_ptr<Snapshot> snapshot(new Snapshot());
+        snapshot->m_buffer = std::move(bytes);
+        snapshot->m_data = snapshot->m_buffer.data();
+        snapshot->m_size = snapshot->m_buffer.size();
+        snapshot->validate();
+        return snapshot;
+    }
+
+    INLINE Snapshot::~Snapshot() = default;
+
+    /* only header and table bounds are checked, records are checked when accessed */
+    INLINE void Snapshot::validate() const
+    {
+        if (m_size < sizeof(SnapshotHeader))
+            throw std::runtime_error("snapshot is too small");
+        const auto& h = header();
+        if (std::memcmp(h.magic, Magic, sizeof(Magic)) != 0)
+            throw std::runtime_error("not a cli-cmd snapshot");
+        if (h.version != Version)
+            throw std::runtime_error("snapshot version " + std::to_string(h.version) + " is not supported");
+        if (h.byteOrder != ByteOrder)
+            throw std::runtime_error("snapshot was written with other byte order");
+        if (h.fileSize != m_size)
+            throw std::runtime_error("snapshot is truncated");
+        auto check = [this](const SnapshotTable& t, size_t recordSize) {
+            if (t.offset % 4 != 0 || uint64_t(t.offset) + uint64_t(t.count) * recordSize > m_size)
+                throw std::runtime_error("snapshot table out of bounds");
+        };
+        check(h.commands, sizeof(SnapshotCommand));
+        check(h.options, sizeof(SnapshotOption));
+        check(h.arguments, sizeof(SnapshotArgument));
+        check(h.hidden, sizeof(SnapshotString));
+        check(h.shorthands, sizeof(SnapshotShorthand));
+        check(h.categories, sizeof(SnapshotCategory));
+        check(h.refs, sizeof(uint32_t));
+        check(h.strings, 1);
+        if (uint64_t(h.globalOptions.offset) + h.globalOptions.count > h.options.count)
+            throw std::runtime_error("snapshot global options out of bounds");
+    }
+
+    INLINE const SnapshotHeader& Snapshot::header() const
+    {
+        return *reinterpret_cast<const SnapshotHeader*>(m_data);
+    }
+
+    template<typename T>
+    const T& Snapshot::record(const SnapshotTable& table, size_t index) const
+    {
+        if (index >= table.count)
+            throw std::out_of_range("snapshot record out of bounds");
+        return reinterpret_cast<const T*>(m_data + table.offset)[index];
+    }
+
+    INLINE const SnapshotCommand& Snapshot::commandRecord(size_t index) const
+    {
+        return record<SnapshotCommand>(header().commands, index);
+    }
+
+    INLINE const SnapshotOption& Snapshot::optionRecord(size_t index) const
+    {
+        return record<SnapshotOption>(header().options, index);
+    }
+
+    INLINE const SnapshotArgument& Snapshot::argumentRecord(size_t index) const
+    {
+        return record<SnapshotArgument>(header().arguments, index);
+    }
+
+    INLINE const SnapshotString& Snapshot::hiddenRecord(size_t index) const
+    {
+        return record<SnapshotString>(header().hidden, index);
+    }
+
+    INLINE std::string_view Snapshot::str(const SnapshotString& s) const
+    {
+        const auto& pool = header().strings;
+        if (uint64_t(s.offset) + s.size > pool.count)
+            throw std::out_of_range("snapshot string out of bounds");
+        return {m_data + pool.offset + s.offset, s.size};
+    }
+
+    INLINE std::string_view Snapshot::appName() const
+    {
+        return str(header().appName);
+    }
+
+    INLINE int Snapshot::cmdDepth() const
+    {
+        return static_cast<int>(header().cmdDepth);
+    }
+
+    INLINE int Snapshot::combineOpts() const
+    {
+        return static_cast<int>(header().combineOpts);
+    }
+
+    INLINE int Snapshot::helpAvailability() const
+    {
+        return static_cast<int>(header().helpAvailability);
+    }
+
+    INLINE size_t Snapshot::commandCount() const
+    {
+        return header().commands.count;
+    }
+
+    INLINE std::string_view Snapshot::commandName(size_t index) const
+    {
+        return str(commandRecord(index).name);
+    }
+
+    INLINE std::string_view Snapshot::commandDesc(size_t index) const
+    {
+        return str(commandRecord(index).desc);
+    }
+
+    INLINE std::optional<size_t> Snapshot::findCommand(std::string_view name) const
+    {
+        size_t lo = 0, hi = commandCount();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (commandName(mid) < name)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < commandCount() && commandName(lo) == name)
+            return lo;
+        return std::nullopt;
+    }
+
+    INLINE std::optional<std::string_view> Snapshot::findShorthand(std::string_view shorthand) const
+    {
+        const auto& table = header().shorthands;
+        size_t lo = 0, hi = table.count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (str(record<SnapshotShorthand>(table, mid).shorthand) < shorthand)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < table.count) {
+            const auto& rec = record<SnapshotShorthand>(table, lo);
+            if (str(rec.shorthand) == shorthand)
+                return str(rec.name);
+        }
+        return std::nullopt;
+    }
+
+    INLINE size_t Snapshot::categoryCount() const
+    {
+        return header().categories.count;
+    }
+
+    INLINE SnapshotCategoryKind Snapshot::categoryKind(size_t index) const
+    {
+        return static_cast<SnapshotCategoryKind>(record<SnapshotCategory>(header().categories, index).kind);
+    }
+
+    INLINE std::string_view Snapshot::categoryDesc(size_t index) const
+    {
+        return str(record<SnapshotCategory>(header().categories, index).desc);
+    }
+
+    INLINE SnapshotRefs Snapshot::categoryRefs(size_t index) const
+    {
+        const auto& range = record<SnapshotCategory>(header().categories, index).refs;
+        const auto& refs = header().refs;
+        if (uint64_t(range.offset) + range.count > refs.count)
+            throw std::out_of_range("snapshot category out of bounds");
+        const auto* first = reinterpret_cast<const uint32_t*>(m_data + refs.offset) + range.offset;
+        return {first, first + range.count};
+    }
+
+    /* collects records and deduplicated strings, lays them out as described in snapshot.h */
+    class SnapshotWriter
+    {
+        std::string m_strings;
+        std::map<std::string, uint32_t, std::less<>> m_pooled;
+
+        static uint32_t narrow(size_t value, const char* what) {
+            if (value >= std::numeric_limits<uint32_t>::max())
+                throw std::length_error(std::string("snapshot: too large ") + what);
+            return static_cast<uint32_t>(value);
+        }
+
+        template<typename T>
+        static void place(std::vector<char>& image, SnapshotTable& table, const std::vector<T>& records) {
+            table.count = narrow(records.size(), "table");
+            if (!records.empty())
+                std::memcpy(image.data() + table.offset, records.data(), records.size() * sizeof(T));
+        }
+    public:
+        SnapshotHeader header{};
+        std::vector<SnapshotCommand> commands;
+        std::vector<SnapshotOption> options;
+        std::vector<SnapshotArgument> arguments;
+        std::vector<SnapshotString> hidden;
+        std::vector<SnapshotShorthand> shorthands;
+        std::vector<SnapshotCategory> categories;
+        std::vector<uint32_t> refs;
+
+        SnapshotString add(std::string_view s) {
+            auto it = m_pooled.find(s);
+            if (it == m_pooled.end()) {
+                it = m_pooled.emplace(std::string(s), narrow(m_strings.size(), "string pool")).first;
+                m_strings.append(s);
+            }
+            return {it->second, narrow(s.size(), "string")};
+        }
+
+        static SnapshotTable range(size_t first, size_t last) {
+            return {narrow(first, "table"), narrow(last - first, "table")};
+        }
+
+        std::vector<char> finish() {
+            size_t offset = sizeof(SnapshotHeader);
+            auto layout = [&offset](SnapshotTable& table, size_t count, size_t recordSize) {
+                table.offset = narrow(offset, "image");
+                offset += count * recordSize;
+            };
+            layout(header.commands, commands.size(), sizeof(SnapshotCommand));
+            layout(header.options, options.size(), sizeof(SnapshotOption));
+            layout(header.arguments, arguments.size(), sizeof(SnapshotArgument));
+            layout(header.hidden, hidden.size(), sizeof(SnapshotString));
+            layout(header.shorthands, shorthands.size(), sizeof(SnapshotShorthand));
+            layout(header.categories, categories.size(), sizeof(SnapshotCategory));
+            layout(header.refs, refs.size(), sizeof(uint32_t));
+            layout(header.strings, m_strings.size(), 1);
+            offset = (offset + 3) & ~size_t(3);
+            header.fileSize = narrow(offset, "image");
+
+            std::vector<char> image(offset, '\0');
+            place(image, header.commands, commands);
+            place(image, header.options, options);
+            place(image, header.arguments, arguments);
+            place(image, header.hidden, hidden);
+            place(image, header.shorthands, shorthands);
+            place(image, header.categories, categories);
+            place(image, header.refs, refs);
+            header.strings.count = narrow(m_strings.size(), "string pool");
+            std::memcpy(image.data() + header.strings.offset, m_strings.data(), m_strings.size());
+            std::memcpy(image.data(), &header, sizeof(header));
+            return image;
+        }
+    };
+
+    INLINE void Application::checkNotFrozen() const
+    {
+        if (frozen)
+            throw std::logic_error("schema is frozen");
+    }
+
+    INLINE void Application::freeze()
+    {
+        if (frozen)
+            return;
+        validatePending();
+        frozen = true;
+        globalOptionsLocked = true;
+        for (const auto& [name, command] : commandMap)
+            command->buildMergedTree();
+        mainCommand->buildMergedOptions();
+        helpCommand->buildMergedOptions();
+    }
+
+    /* first abbreviation or completion pays for it, so loadSnapshot() doesn't read every name */
+    INLINE const PrefixIndex& Application::commandNames()
+    {
+        std::call_once(commandIndexOnce, [this]() {
+            std::vector<std::string> names;
+            for (const auto& [name, command] : commandMap)
+                names.push_back(name);
+            if (snapshot)
+                for (size_t i = 0; i < snapshot->commandCount(); i++)
+                    names.emplace_back(snapshot->commandName(i));
+            commandIndex = PrefixIndex(std::move(names));
+            // caption of the first category of each command, in order of commandIndex
+            commandGroups.assign(commandIndex.size(), {});
+            auto group = [this](std::string_view name, const std::string& caption) {
+                auto match = commandIndex.find(name);
+                if (match.exact && commandGroups[match.first].empty())
+                    commandGroups[match.first] = caption;
+            };
+            for (const auto* list : {&categories, &helpCategories})
+                for (const auto& category : *list)
+                    for (const auto& command : category->commands)
+                        group(command->m_name, category->description);
+            if (snapshot)
+                for (size_t i = 0; i < snapshot->categoryCount(); i++) {
+                    if (snapshot->categoryKind(i) == SnapshotCategoryKind::TopLevel)
+                        continue;
+                    std::string caption(snapshot->categoryDesc(i));
+                    for (uint32_t ref : snapshot->categoryRefs(i))
+                        group(snapshot->commandName(ref), caption);
+                }
+        });
+        return commandIndex;
+    }
+
+    INLINE std::vector<char> Application::snapshotImage()
+    {
+        if (snapshot)
+            throw std::logic_error("application loaded from snapshot can't be saved again");
+        freeze();
+        if (!formal.prefixMap.empty())
+            throw std::logic_error("snapshot can't keep global prefix parameters");
+        SnapshotWriter w;
+        std::memcpy(w.header.magic, Snapshot::Magic, sizeof(Snapshot::Magic));
+        w.header.version = Snapshot::Version;
+        w.header.byteOrder = Snapshot::ByteOrder;
+        w.header.cmdDepth = static_cast<uint32_t>(cmdDepth);
+        w.header.combineOpts = static_cast<uint32_t>(combineOpts);
+        w.header.helpAvailability = static_cast<uint32_t>(helpAvailability);
+        w.header.appName = w.add(appName);
+
+        auto addOptions = [&w](const Formal& f) {
+            size_t first = w.options.size();
+            for (const auto& [name, opt] : f.optionMap) {
+                SnapshotOption rec{};
+                rec.name = w.add(name);
+                rec.desc = w.add(opt->description());
+                rec.kind = static_cast<uint32_t>(opt->kind());
+                if (opt->kind() == OptionKind::Parameter) {
+                    auto parameter = dynamic_cast<const Parameter*>(opt.get());
+                    rec.expect = w.add(parameter->expectType());
+                    rec.defValue = w.add(parameter->defValue());
+                    rec.mode = static_cast<uint32_t>(parameter->parameterMode());
+                    if (parameter->repeatable())
+                        rec.mode |= Snapshot::RepeatableMode;
+                    if (parameter->keyValue())
+                        rec.mode |= Snapshot::KeyValueMode;
+                }
+                w.options.push_back(rec);
+            }
+            return SnapshotWriter::range(first, w.options.size());
+        };
+        w.header.globalOptions = addOptions(formal);
+
+        std::map<const Command*, uint32_t> indexOf;
+        for (const auto& [name, command] : commandMap) {
+            command->materialize();
+            if (!command->subcommands.empty())
+                throw std::logic_error("snapshot can't keep nested commands of " + name);
+            if (!command->formal.prefixMap.empty())
+                throw std::logic_error("snapshot can't keep prefix parameters of " + name);
+            if (command->m_argsFrom)
+                throw std::logic_error("snapshot can't keep streamed arguments of " + name);
+            indexOf[command.get()] = static_cast<uint32_t>(w.commands.size());
+            SnapshotCommand rec{};
+            rec.name = w.add(name);
+            rec.desc = w.add(command->m_desc);
+            rec.options = addOptions(command->formal);
+            size_t first = w.arguments.size();
+            for (const auto& a : command->formal.argList)
+                w.arguments.push_back({w.add(a.name()), w.add(a.expectType())});
+            rec.arguments = SnapshotWriter::range(first, w.arguments.size());
+            first = w.hidden.size();
+            for (const auto& h : command->hiddenOptNames)
+                w.hidden.push_back(w.add(h));
+            rec.hidden = SnapshotWriter::range(first, w.hidden.size());
+            const auto& va = command->formal.vaArgs;
+            if (va.max_n > 0) {
+                rec.vaArgs = {w.add(va.name()), w.add(va.expectType())};
+                if (va.min_n >= std::numeric_limits<uint32_t>::max())
+                    throw std::length_error("snapshot: too large min_n of " + name);
+                rec.minN = static_cast<uint32_t>(va.min_n);
+                rec.maxN = static_cast<uint32_t>(std::min<size_t>(va.max_n, std::numeric_limits<uint32_t>::max()));
+            }
+            w.commands.push_back(rec);
+        }
+
+        for (const auto& [shorthand, name] : shorthandMap)
+            w.shorthands.push_back({w.add(shorthand), w.add(name)});
+
+        auto addCategory = [&](SnapshotCategoryKind kind, const std::string& desc,
+                const std::vector<std::shared_ptr<Command>>& members) {
+            SnapshotCategory rec{};
+            rec.desc = w.add(desc);
+            rec.kind = static_cast<uint32_t>(kind);
+            size_t first = w.refs.size();
+            for (const auto& command : members)
+                w.refs.push_back(indexOf.at(command.get()));
+            rec.refs = SnapshotWriter::range(first, w.refs.size());
+            w.categories.push_back(rec);
+        };
+        addCategory(SnapshotCategoryKind::TopLevel, "", commands);
+        for (const auto& category : categories)
+            addCategory(SnapshotCategoryKind::Category, category->description, category->commands);
+        for (const auto& category : helpCategories)
+            addCategory(SnapshotCategoryKind::HelpCategory, category->description, category->commands);
+        return w.finish();
+    }
+
+    INLINE void Application::saveSnapshot(const std::string& path)
+    {
+        auto image = snapshotImage();
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!out)
+            throw std::runtime_error("can't write snapshot " + path);
+    }
+
+    INLINE void Application::loadSnapshot(std::shared_ptr<const Snapshot> image)
+    {
+        if (!image)
+            throw std::invalid_argument("snapshot is null");
+        if (snapshot || !commandMap.empty() || !formal.optionMap.empty())
+            throw std::logic_error("snapshot must be loaded into application without commands and global options");
+        if (image->cmdDepth() != cmdDepth || image->combineOpts() != combineOpts)
+            throw std::invalid_argument("snapshot was made for other cmdDepth or combineOpts mode");
+        const auto& globals = image->header().globalOptions;
+        for (size_t i = 0; i < globals.count; i++) {
+            auto opt = snapshotOption(*image, image->optionRecord(globals.offset + i));
+            formal.optionMap.emplace(opt->name(), opt);
+        }
+        snapshot = std::move(image);
+        freeze();
+    }
+
+    INLINE Application& Application::bindHandler(const std::string& name, Action handler)
+    {
+        validatePending();
+        auto it = commandMap.find(name);
+        if (it != commandMap.end())
+            it->second->handler(handler);
+        else if (snapshot && snapshot->findCommand(name))
+            handlerBindings[name] = std::move(handler);
+        else
+            throw std::runtime_error("command not found: " + name);
+        return *this;
+    }
+
+    INLINE std::shared_ptr<Option> Application::snapshotOption(const Snapshot& image, const SnapshotOption& rec)
+    {
+        std::string name(image.str(rec.name));
+        std::string desc(image.str(rec.desc));
+        if (static_cast<OptionKind>(rec.kind) == OptionKind::Flag)
+            return std::make_shared<Flag>(std::move(name), std::move(desc));
+        return std::make_shared<Parameter>(std::move(name), std::move(desc), std::string(image.str(rec.defValue)),
+            std::string(image.str(rec.expect)), static_cast<ParameterMode>(rec.mode & 0xFF),
+            (rec.mode & Snapshot::RepeatableMode) != 0, (rec.mode & Snapshot::KeyValueMode) != 0);
+    }
+
+    /* builds Command from image record, as addCommand and add* would, but without checks done at save */
+    INLINE std::shared_ptr<Command> Application::materialize(size_t index)
+    {
+        const auto& rec = snapshot->commandRecord(index);
+        std::string name(snapshot->str(rec.name));
+        auto command = std::make_shared<Command>(name, this);
+        command->m_desc = std::string(snapshot->str(rec.desc));
+        for (size_t i = 0; i < rec.options.count; i++) {
+            auto opt = snapshotOption(*snapshot, snapshot->optionRecord(rec.options.offset + i));
+            command->formal.optionMap.emplace(opt->name(), opt);
+        }
+        for (size_t i = 0; i < rec.arguments.count; i++) {
+            const auto& a = snapshot->argumentRecord(rec.arguments.offset + i);
+            command->formal.argList.emplace_back(std::string(snapshot->str(a.name)), std::string(snapshot->str(a.expect)));
+        }
+        if (rec.maxN > 0) {
+            size_t maxN = rec.maxN == std::numeric_limits<uint32_t>::max() ? std::numeric_limits<size_t>::max() : rec.maxN;
+            command->formal.vaArgs = VaArguments(std::string(snapshot->str(rec.vaArgs.name)),
+                std::string(snapshot->str(rec.vaArgs.expect)), rec.minN, maxN);
+        }
+        for (size_t i = 0; i < rec.hidden.count; i++)
+            command->hiddenOptNames.emplace(snapshot->str(snapshot->hiddenRecord(rec.hidden.offset + i)));
+        auto bound = handlerBindings.find(name);
+        if (bound != handlerBindings.end()) {
+            command->m_handler = std::move(bound->second);
+            handlerBindings.erase(bound);
+        }
+        command->buildMergedOptions();
+        commandMap.emplace(std::move(name), command);
+        return command;
+    }
+
+    INLINE void Application::printSnapshotCategories(SnapshotCategoryKind kind, const SchemaOverlay* overlay) const
+    {
+        if (!snapshot)
+            return;
+        for (size_t i = 0; i < snapshot->categoryCount(); i++) {
+            if (snapshot->categoryKind(i) != kind)
+                continue;
+            if (kind != SnapshotCategoryKind::TopLevel)
+                std::cout << std::endl << snapshot->categoryDesc(i) << std::endl;
+            for (uint32_t index : snapshot->categoryRefs(i))
+                if (!overlay || !overlay->hides(snapshot->commandName(index)))
+                    std::cout << commandLine(snapshot->commandName(index), snapshot->commandDesc(index)) << std::endl;
+        }
+    }
+}
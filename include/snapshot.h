@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli
+{
+    class Application;
+    class MappedFile;
+
+    /*
+     * Binary image of frozen Application. All references are 32-bit offsets from the start
+     * of image, so it can be mapped at any address and read in place. Layout:
+     *
+     *   SnapshotHeader | commands | options | arguments | hidden | shorthands | categories | refs | strings
+     *
+     * Commands are sorted by name, local options of command are sorted by name,
+     * shorthands are sorted by shorthand. Handlers are code and are not part of image.
+     */
+    struct SnapshotString {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct SnapshotTable {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t fileSize;
+        uint32_t cmdDepth;
+        uint32_t combineOpts;
+        uint32_t helpAvailability;
+        SnapshotString appName;
+        SnapshotTable globalOptions;   // range of options
+        SnapshotTable commands;
+        SnapshotTable options;
+        SnapshotTable arguments;
+        SnapshotTable hidden;          // SnapshotString
+        SnapshotTable shorthands;
+        SnapshotTable categories;
+        SnapshotTable refs;            // uint32_t command index
+        SnapshotTable strings;         // count is size in bytes
+    };
+
+    struct SnapshotOption {
+        SnapshotString name;
+        SnapshotString desc;
+        SnapshotString expect;
+        SnapshotString defValue;
+        uint32_t kind;
+        uint32_t mode;                 // ParameterMode, RepeatableMode and KeyValueMode bits
+    };
+
+    struct SnapshotArgument {
+        SnapshotString name;
+        SnapshotString expect;
+    };
+
+    struct SnapshotCommand {
+        SnapshotString name;
+        SnapshotString desc;
+        SnapshotTable options;         // range of options
+        SnapshotTable arguments;       // range of arguments
+        SnapshotTable hidden;          // range of hidden
+        SnapshotArgument vaArgs;
+        uint32_t minN;
+        uint32_t maxN;                 // UINT32_MAX is unlimited
+    };
+
+    struct SnapshotShorthand {
+        SnapshotString shorthand;
+        SnapshotString name;
+    };
+
+    enum class SnapshotCategoryKind : uint32_t {
+        TopLevel = 0,                  // commands added directly to Application
+        Category = 1,
+        HelpCategory = 2
+    };
+
+    struct SnapshotCategory {
+        SnapshotString desc;
+        uint32_t kind;
+        SnapshotTable refs;            // range of refs
+    };
+
+    struct SnapshotRefs {
+        const uint32_t* first;
+        const uint32_t* last;
+        [[nodiscard]] const uint32_t* begin() const { return first; }
+        [[nodiscard]] const uint32_t* end() const { return last; }
+    };
+
+    class Snapshot {
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        std::unique_ptr<MappedFile> m_file;
+        std::vector<char> m_buffer;
+        friend class Application;
+
+        Snapshot() = default;
+        void validate() const;
+        [[nodiscard]] const SnapshotHeader& header() const;
+        template<typename T>
+        [[nodiscard]] const T& record(const SnapshotTable& table, size_t index) const;
+        [[nodiscard]] const SnapshotCommand& commandRecord(size_t index) const;
+        [[nodiscard]] const SnapshotOption& optionRecord(size_t index) const;
+        [[nodiscard]] const SnapshotArgument& argumentRecord(size_t index) const;
+        [[nodiscard]] const SnapshotString& hiddenRecord(size_t index) const;
+    public:
+        static constexpr char Magic[8] = {'C', 'L', 'I', 'C', 'M', 'D', 'S', 'N'};
+        static constexpr uint32_t Version = 1;
+        static constexpr uint32_t ByteOrder = 0x01020304;
+        static constexpr uint32_t RepeatableMode = 0x100;
+        static constexpr uint32_t KeyValueMode = 0x200;
+
+        /**
+         * @brief Maps image file read-only (reads it on platforms without mmap)
+         * @throws std::runtime_error if file can't be opened or is not valid image of this version
+         */
+        static std::shared_ptr<const Snapshot> open(const std::string& path);
+        static std::shared_ptr<const Snapshot> fromBytes(std::vector<char> bytes);
+
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot();
+
+        [[nodiscard]] std::string_view str(const SnapshotString& s) const;
+        [[nodiscard]] std::string_view appName() const;
+        [[nodiscard]] int cmdDepth() const;
+        [[nodiscard]] int combineOpts() const;
+        [[nodiscard]] int helpAvailability() const;
+        [[nodiscard]] size_t commandCount() const;
+        [[nodiscard]] std::string_view commandName(size_t index) const;
+        [[nodiscard]] std::string_view commandDesc(size_t index) const;
+        [[nodiscard]] std::optional<size_t> findCommand(std::string_view name) const;
+        [[nodiscard]] std::optional<std::string_view> findShorthand(std::string_view shorthand) const;
+        [[nodiscard]] size_t categoryCount() const;
+        [[nodiscard]] SnapshotCategoryKind categoryKind(size_t index) const;
+        [[nodiscard]] std::string_view categoryDesc(size_t index) const;
+        [[nodiscard]] SnapshotRefs categoryRefs(size_t index) const;
+    };
+}
@@ -0,0 +1,272 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include "cli-cmd.h"
+#include "utf8.h"
+
+namespace cli
+{
+    /*
+     * Compile-time schema. Commands, options and arguments are declared as constexpr tables,
+     * StaticSchema checks names and sorts commands during compilation, so wrong table
+     * is compile error, as with static_assert:
+     *
+     *     constexpr cli::StaticOption cloneOptions[] = {
+     *         cli::flag("--verbose", "-v", "be more verbose"),
+     *     };
+     *     constexpr cli::StaticArgument cloneArguments[] = {
+     *         cli::arg("repository", "url"),
+     *     };
+     *     constexpr cli::StaticCommand commands[] = {
+     *         cli::command("clone", "Clone a repository", cloneOptions, cloneArguments, clone_),
+     *     };
+     *     constexpr cli::StaticSchema schema(commands, true); // combineOpts
+     *     ...
+     *     app.addCommands(schema);
+     */
+
+    using StaticHandler = int (*)(const Actual*);
+
+    struct StaticOption {
+        OptionKind kind = OptionKind::Flag;
+        std::string_view name;
+        std::string_view shorthand;
+        std::string_view desc;
+        std::string_view expect;
+        std::string_view defValue;
+        ParameterMode mode = ParameterMode::Optional;
+    };
+
+    struct StaticArgument {
+        std::string_view name;
+        std::string_view expect;
+        bool variadic = false;
+        size_t min_n = 0;
+        size_t max_n = 0;
+    };
+
+    struct StaticCommand {
+        std::string_view name;
+        std::string_view desc;
+        const StaticOption* options = nullptr;
+        size_t optionCount = 0;
+        const StaticArgument* arguments = nullptr;
+        size_t argumentCount = 0;
+        StaticHandler handler = nullptr;
+    };
+
+    constexpr StaticOption flag(std::string_view name, std::string_view shorthand, std::string_view desc) {
+        return {OptionKind::Flag, name, shorthand, desc, {}, {}, ParameterMode::Optional};
+    }
+
+    constexpr StaticOption parameter(std::string_view name, std::string_view shorthand,
+            std::string_view desc, std::string_view expect) {
+        return {OptionKind::Parameter, name, shorthand, desc, expect, {}, ParameterMode::Optional};
+    }
+
+    constexpr StaticOption reqParameter(std::string_view name, std::string_view shorthand,
+            std::string_view desc, std::string_view expect) {
+        return {OptionKind::Parameter, name, shorthand, desc, expect, {}, ParameterMode::Required};
+    }
+
+    constexpr StaticOption defParameter(std::string_view name, std::string_view shorthand,
+            std::string_view desc, std::string_view expect, std::string_view defValue) {
+        return {OptionKind::Parameter, name, shorthand, desc, expect, defValue, ParameterMode::Defaulted};
+    }
+
+    constexpr StaticArgument arg(std::string_view name, std::string_view expect) {
+        return {name, expect, false, 1, 1};
+    }
+
+    constexpr StaticArgument args(std::string_view name, std::string_view expect, size_t min_n,
+            size_t max_n = std::numeric_limits<size_t>::max()) {
+        return {name, expect, true, min_n, max_n};
+    }
+
+    constexpr StaticCommand command(std::string_view name, std::string_view desc, StaticHandler handler = nullptr) {
+        return {name, desc, nullptr, 0, nullptr, 0, handler};
+    }
+
+    template<size_t NO>
+    constexpr StaticCommand command(std::string_view name, std::string_view desc,
+            const StaticOption (&options)[NO], StaticHandler handler = nullptr) {
+        return {name, desc, options, NO, nullptr, 0, handler};
+    }
+
+    template<size_t NA>
+    constexpr StaticCommand command(std::string_view name, std::string_view desc,
+            const StaticArgument (&arguments)[NA], StaticHandler handler = nullptr) {
+        return {name, desc, nullptr, 0, arguments, NA, handler};
+    }
+
+    template<size_t NO, size_t NA>
+    constexpr StaticCommand command(std::string_view name, std::string_view desc,
+            const StaticOption (&options)[NO], const StaticArgument (&arguments)[NA],
+            StaticHandler handler = nullptr) {
+        return {name, desc, options, NO, arguments, NA, handler};
+    }
+
+    /* constexpr counterparts of classifyToken, for ASCII names declared in schema */
+    constexpr bool isNameBody(std::string_view s, bool allowDash) {
+        if (s.empty() || !isAsciiAlpha(s.front()) || s.back() == '-')
+            return false;
+        for (char c : s)
+            if (!(isAsciiAlnum(c) || (allowDash && c == '-')))
+                return false;
+        return true;
+    }
+
+    constexpr bool isCommandName(std::string_view s) {
+        return isNameBody(s, true) && s != "help";
+    }
+
+    constexpr bool isShortOptionName(std::string_view s) {
+        return s.size() == 2 && s[0] == '-' && isAsciiAlpha(s[1]);
+    }
+
+    constexpr bool isOptionName(std::string_view s, bool combineOpts) {
+        if (s.size() > 2 && s[0] == '-' && s[1] == '-')
+            return s.size() >= 4 && isNameBody(s.substr(2), true);
+        if (isShortOptionName(s))
+            return true;
+        return !combineOpts && s.size() > 2 && s[0] == '-' && isNameBody(s.substr(1), true);
+    }
+
+    constexpr bool checkStaticOption(const StaticOption& o, bool combineOpts) {
+        if (!isOptionName(o.name, combineOpts))
+            return false;
+        if (!o.shorthand.empty() && !isShortOptionName(o.shorthand))
+            return false;
+        if (isShortOptionName(o.name) && !o.shorthand.empty() && o.shorthand != o.name)
+            return false;
+        if (o.kind == OptionKind::Parameter && o.expect.empty())
+            return false;
+        if (o.mode == ParameterMode::Defaulted && o.defValue.empty())
+            return false;
+        return true;
+    }
+
+    constexpr std::string_view effectiveShorthand(const StaticOption& o) {
+        return isShortOptionName(o.name) ? o.name : o.shorthand;
+    }
+
+    template<size_t N>
+    class StaticSchema {
+        std::array<StaticCommand, N> m_commands{};
+        bool m_combineOpts;
+
+        constexpr void checkCommand(const StaticCommand& c) const {
+            if (!isCommandName(c.name))
+                throw std::invalid_argument("static schema: bad command name");
+            bool variadic = false;
+            for (size_t i = 0; i < c.argumentCount; i++) {
+                if (variadic)
+                    throw std::invalid_argument("static schema: variadic argument must be last");
+                variadic = c.arguments[i].variadic;
+                if (c.arguments[i].name.empty() || c.arguments[i].expect.empty())
+                    throw std::invalid_argument("static schema: argument needs name and type");
+            }
+            for (size_t i = 0; i < c.optionCount; i++) {
+                if (!checkStaticOption(c.options[i], m_combineOpts))
+                    throw std::invalid_argument("static schema: bad option");
+                for (size_t j = 0; j < i; j++)
+                    if (c.options[i].name == c.options[j].name)
+                        throw std::invalid_argument("static schema: option defined twice");
+            }
+        }
+
+        /* shorthands are unique in whole application, as in Formal::addShorthand */
+        constexpr void checkShorthands() const {
+            for (size_t c1 = 0; c1 < N; c1++)
+                for (size_t o1 = 0; o1 < m_commands[c1].optionCount; o1++) {
+                    auto s1 = effectiveShorthand(m_commands[c1].options[o1]);
+                    if (s1.empty())
+                        continue;
+                    for (size_t c2 = c1; c2 < N; c2++)
+                        for (size_t o2 = c2 == c1 ? o1 + 1 : 0; o2 < m_commands[c2].optionCount; o2++)
+                            if (effectiveShorthand(m_commands[c2].options[o2]) == s1)
+                                throw std::invalid_argument("static schema: shorthand already taken");
+                }
+        }
+
+    public:
+        constexpr StaticSchema(const StaticCommand (&commands)[N], bool combineOpts): m_combineOpts(combineOpts) {
+            for (size_t i = 0; i < N; i++) {
+                checkCommand(commands[i]);
+                // insertion sort, N is small and std::sort is not constexpr in C++17
+                size_t j = i;
+                while (j > 0 && commands[i].name < m_commands[j - 1].name) {
+                    m_commands[j] = m_commands[j - 1];
+                    j--;
+                }
+                m_commands[j] = commands[i];
+            }
+            for (size_t i = 1; i < N; i++)
+                if (m_commands[i - 1].name == m_commands[i].name)
+                    throw std::invalid_argument("static schema: command defined twice");
+            checkShorthands();
+        }
+
+        [[nodiscard]] constexpr const StaticCommand* find(std::string_view name) const {
+            size_t lo = 0, hi = N;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (m_commands[mid].name < name)
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            return lo < N && m_commands[lo].name == name ? &m_commands[lo] : nullptr;
+        }
+
+        [[nodiscard]] constexpr const StaticCommand* begin() const { return m_commands.data(); }
+        [[nodiscard]] constexpr const StaticCommand* end() const { return m_commands.data() + N; }
+        [[nodiscard]] constexpr size_t size() const { return N; }
+        [[nodiscard]] constexpr bool combineOpts() const { return m_combineOpts; }
+    };
+
+    template<size_t N>
+    StaticSchema(const StaticCommand (&)[N], bool) -> StaticSchema<N>;
+
+    /* seeded FNV-1a with final mixing, shared by tools/clicmd-gen and generated lookups */
+    constexpr uint32_t schemaHash(std::string_view s, uint32_t seed) {
+        uint32_t h = 2166136261u ^ seed;
+        for (char c : s) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        return h;
+    }
+
+    /**
+     * @brief Perfect hash of command names (hash and displace), emitted by tools/clicmd-gen
+     *
+     * Key goes to bucket by hash with seed 0, bucket seed gives its slot,
+     * slot keeps index in sorted StaticSchema or -1.
+     */
+    struct StaticHashIndex {
+        const uint32_t* seeds;
+        size_t bucketCount;
+        const int32_t* slots;
+        size_t slotCount;
+
+        [[nodiscard]] constexpr const StaticCommand* find(std::string_view name, const StaticCommand* commands) const {
+            uint32_t seed = seeds[schemaHash(name, 0) % bucketCount];
+            int32_t index = slots[schemaHash(name, seed) % slotCount];
+            return index >= 0 && commands[index].name == name ? &commands[index] : nullptr;
+        }
+    };
+
+    template<size_t N>
+    Application& Application::addCommands(const StaticSchema<N>& schema) {
+        return addStaticCommands(schema.begin(), schema.size(), schema.combineOpts());
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+
+#include "unicode-ranges.h"
+#include "utf8.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CLICMD_UTF8_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define CLICMD_UTF8_NEON
+#endif
+
+namespace cli
+{
+    /* length of ASCII prefix, vectorized part of findInvalidUtf8 */
+    INLINE size_t asciiPrefixLength(const char* data, size_t len) {
+        size_t i = 0;
+#if defined(CLICMD_UTF8_SSE2)
+        for (; i + 16 <= len; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            int mask = _mm_movemask_epi8(block);
+            if (mask != 0)
+                return i + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+#elif defined(CLICMD_UTF8_NEON)
+        for (; i + 16 <= len; i += 16) {
+            uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+            if (vmaxvq_u8(block) >= 0x80)
+                break;
+        }
+#endif
+        while (i < len && static_cast<unsigned char>(data[i]) < 0x80)
+            i++;
+        return i;
+    }
+
+    INLINE size_t decodeUtf8(const char* data, size_t len, char32_t& codePoint) {
+        auto byte = [data](size_t k) { return static_cast<unsigned char>(data[k]); };
+        if (len == 0)
+            return 0;
+        unsigned char b0 = byte(0);
+        if (b0 < 0x80) {
+            codePoint = b0;
+            return 1;
+        }
+        size_t n;
+        unsigned char lo = 0x80, hi = 0xBF; // allowed range of second byte
+        if (b0 >= 0xC2 && b0 <= 0xDF) {
+            n = 2;
+        } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+            n = 3;
+            if (b0 == 0xE0) lo = 0xA0;      // overlong
+            else if (b0 == 0xED) hi = 0x9F; // surrogates
+        } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+            n = 4;
+            if (b0 == 0xF0) lo = 0x90;      // overlong
+            else if (b0 == 0xF4) hi = 0x8F; // above U+10FFFF
+        } else
+            return 0;
+        if (len < n)
+            return 0;
+        if (byte(1) < lo || byte(1) > hi)
+            return 0;
+        for (size_t k = 2; k < n; k++)
+            if ((byte(k) & 0xC0) != 0x80)
+                return 0;
+        char32_t cp = b0 & (0x7F >> n);
+        for (size_t k = 1; k < n; k++)
+            cp = (cp << 6) | (byte(k) & 0x3F);
+        codePoint = cp;
+        return n;
+    }
+
+    INLINE size_t findInvalidUtf8(const char* data, size_t len) {
+        size_t i = 0;
+        while (i < len) {
+            if (static_cast<unsigned char>(data[i]) < 0x80) {
+                i += asciiPrefixLength(data + i, len - i);
+                continue;
+            }
+            char32_t cp;
+            size_t n = decodeUtf8(data + i, len - i, cp);
+            if (n == 0)
+                return i;
+            i += n;
+        }
+        return std::string::npos;
+    }
+
+    INLINE bool isValidUtf8(const std::string& s) {
+        return findInvalidUtf8(s.data(), s.size()) == std::string::npos;
+    }
+
+    template<size_t N>
+    INLINE bool inRanges(const CodePointRange (&ranges)[N], char32_t cp) {
+        auto it = std::upper_bound(std::begin(ranges), std::end(ranges), cp,
+            [](char32_t value, const CodePointRange& range) { return value < range.first; });
+        return it != std::begin(ranges) && cp <= std::prev(it)->last;
+    }
+
+    /* general category L, binary search in table of unicode-ranges.h */
+    INLINE bool isUnicodeLetter(char32_t cp) {
+        if (cp < 0x80)
+            return isAsciiAlpha(static_cast<char>(cp));
+        return inRanges(unicodeLetterRanges, cp);
+    }
+
+    INLINE bool isUnicodeIdentifier(const std::string& s) {
+        if (s.empty() || s.back() == '-')
+            return false;
+        size_t i = 0;
+        bool first = true;
+        while (i < s.size()) {
+            char32_t cp;
+            size_t n = decodeUtf8(s.data() + i, s.size() - i, cp);
+            if (n == 0)
+                return false;
+            bool letter = isUnicodeLetter(cp);
+            if (first && !letter)
+                return false;
+            // combining marks complete letters of many scripts, as vowel signs of Devanagari
+            if (!letter && cp != '-' && !(cp < 0x80 && isAsciiDigit(static_cast<char>(cp)))
+                    && !(cp >= 0x80 && inRanges(unicodeMarkRanges, cp)))
+                return false;
+            first = false;
+            i += n;
+        }
+        return true;
+    }
+}
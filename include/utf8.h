@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace cli
+{
+    /**
+     * @brief Finds first byte which breaks UTF-8 well-formedness
+     *
+     * ASCII runs are skipped 16 bytes at a time with SSE2 (x86-64) or NEON (aarch64),
+     * multibyte sequences are checked by scalar code, which is also the fallback
+     * on other platforms. Overlong forms, surrogates and code points above U+10FFFF
+     * are rejected, as required by RFC 3629.
+     *
+     * @return offset of the first invalid byte or std::string::npos if input is valid
+     */
+    size_t findInvalidUtf8(const char* data, size_t len);
+
+    bool isValidUtf8(const std::string& s);
+
+    /**
+     * @brief Decodes one code point, returns its length in bytes or 0 for malformed sequence
+     */
+    size_t decodeUtf8(const char* data, size_t len, char32_t& codePoint);
+
+    /**
+     * @brief Identifier in UTF-8: like ASCII identifier, but any non-ASCII letter is allowed
+     *
+     * Starts with letter, contains letters, combining marks, ASCII digits or dashes, cannot end
+     * with dash. Letters are code points of Unicode general category L, marks of Mn and Mc
+     * (tables in unicode-ranges.h); symbols, punctuation, digits of other scripts are not allowed.
+     */
+    bool isUnicodeIdentifier(const std::string& s);
+
+    constexpr bool isAsciiAlpha(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    constexpr bool isAsciiDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    constexpr bool isAsciiAlnum(char c) {
+        return isAsciiAlpha(c) || isAsciiDigit(c);
+    }
+}
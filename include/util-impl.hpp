@@ -2,6 +2,7 @@
 #include <cstdarg>
 #include <stdexcept>
 #include "util.h"
+#include "utf8.h"
 #include "iostream"
 #include "error_codes.h"
 
@@ -59,16 +60,18 @@ namespace cli
         }
     }
 
-    INLINE int classifyToken(const std::string& s, bool combineOpts)
+    INLINE int classifyToken(const std::string& s, bool combineOpts, bool unicodeIdents)
     {
         if (s.empty()) return ArgError::InvalidEmpty;
         if (s == "-") return ArgError::InvalidDashOnly;
 
         if (s[0] != '-') {
             // BareIdentifier or Freeform
-            if (!isalpha(s[0]) || s.back() == '-') return ArgType::Freeform;
+            if (unicodeIdents)
+                return isUnicodeIdentifier(s) ? ArgType::BareIdentifier : ArgType::Freeform;
+            if (!isAsciiAlpha(s[0]) || s.back() == '-') return ArgType::Freeform;
             for (char c : s) {
-                if (!(isalnum(c) || c == '-')) return ArgType::Freeform;
+                if (!(isAsciiAlnum(c) || c == '-')) return ArgType::Freeform;
             }
             return ArgType::BareIdentifier;
         }
@@ -78,10 +81,10 @@ namespace cli
             auto eq = s.find('=');
             std::string key = eq == std::string::npos ? s.substr(2) : s.substr(2, eq - 2);
 
-            if (key.size() < 2 || !isalpha(key.front()) || key.back() == '-')
+            if (key.size() < 2 || !isAsciiAlpha(key.front()) || key.back() == '-')
                 return ArgError::InvalidLongOptionSyntax;
             for (char c : key) {
-                if (!(isalnum(c) || c == '-'))
+                if (!(isAsciiAlnum(c) || c == '-'))
                     return ArgError::InvalidLongOptionSyntax;
             }
             return (eq != std::string::npos) ? ArgType::LongEquals : ArgType::LongOption;
@@ -94,10 +97,10 @@ namespace cli
             if (!combineOpts) {
                 // GCC style: whole string after '-' interpreted as one option
                 // can have '-' inside
-                if (!isalpha(group.front()) || group.back() == '-')
+                if (!isAsciiAlpha(group.front()) || group.back() == '-')
                     return ArgError::InvalidGccOptionSyntax;
                 for (char c : group) {
-                    if (!isalnum(c) && c != '-') return ArgError::InvalidGccOptionSyntax;
+                    if (!isAsciiAlnum(c) && c != '-') return ArgError::InvalidGccOptionSyntax;
                 }
                 if (group.size() == 1)
                     return (eq != std::string::npos) ? ArgType::ShortEquals : ArgType::ShortOption;
@@ -106,7 +109,7 @@ namespace cli
             } else {
                 // Git-style compact flags (only letters/digits, without '-')
                 for (char c : group) {
-                    if (!isalpha(c)) return ArgError::InvalidCompactSyntax;
+                    if (!isAsciiAlpha(c)) return ArgError::InvalidCompactSyntax;
                 }
                 if (group.size() == 1)
                     return (eq != std::string::npos) ? ArgType::ShortEquals : ArgType::ShortOption;
@@ -147,8 +150,8 @@ namespace cli
         return os << to_string_argtype(static_cast<int>(type));
     }
 
-    INLINE std::string tokenError(const std::string& token, int expectedType, bool combineOpts) {
-        int type = classifyToken(token, combineOpts);
+    INLINE std::string tokenError(const std::string& token, int expectedType, bool combineOpts, bool unicodeIdents) {
+        int type = classifyToken(token, combineOpts, unicodeIdents);
         return (type != expectedType)
             ? "Token " + token + " expected " + to_string_argtype(expectedType) + " but got " + to_string_argtype(type)
             : "";
@@ -180,6 +183,11 @@ namespace cli
             case ErrorCode::RequiredParameterMissing: return "RequiredParameterMissing";
             case ErrorCode::UnexpectedCommandLineEnd: return "UnexpectedCommandLineEnd";
             case ErrorCode::OptionUsedTwice: return "OptionUsedTwice";
+            case ErrorCode::InvalidUtf8: return "InvalidUtf8";
+            case ErrorCode::AmbiguousPrefix: return "AmbiguousPrefix";
+            case ErrorCode::BadKeyValue: return "BadKeyValue";
+            case ErrorCode::ArgsSourceUnreadable: return "ArgsSourceUnreadable";
+            case ErrorCode::ResponseFileCycle: return "ResponseFileCycle";
             default: return "<unknown>";
         }
     }
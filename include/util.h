@@ -41,10 +41,11 @@ namespace cli
         InvalidGccOptionSyntax   = -5,
     };
 
-    int classifyToken(const std::string& s, bool combineOpts);
+    int classifyToken(const std::string& s, bool combineOpts, bool unicodeIdents = false);
     const char* to_string_argtype(int code);
     std::ostream& operator<<(std::ostream& os, ArgType type);
-    std::string tokenError(const std::string& token, int expectedType, bool combineOpts);
+    std::string tokenError(const std::string& token, int expectedType, bool combineOpts,
+                           bool unicodeIdents = false);
     std::string tokenError(const std::string& token, const std::vector<int>& expectedTypes, bool combineOpts);
     std::pair<std::string, std::string> splitEquals(const std::string& token);
 
@@ -1,7 +1,10 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <filesystem>
 #include <set>
 
+#include "utf8.h"
 #include "validator.h"
 
 namespace cli {
@@ -96,6 +99,75 @@ namespace cli {
         return validators_.count(name) > 0;
     }
 
+    INLINE CompletionSource Validator::completionSource() const {
+        auto values = choices();
+        if (values.empty())
+            return nullptr;
+        return [values](const std::string& prefix) {
+            std::vector<std::string> result;
+            for (const auto& value : values)
+                if (value.compare(0, prefix.size(), prefix) == 0)
+                    result.push_back(value);
+            return result;
+        };
+    }
+
+    INLINE CompletionSource ValidatorManager::completionSource(const std::string &names) const {
+        std::vector<CompletionSource> sources;
+        for (const auto& name: split_by_space(names)) {
+            auto it = validators_.find(name);
+            if (it == validators_.end())
+                continue;
+            if (auto source = it->second->completionSource())
+                sources.push_back(std::move(source));
+        }
+        if (sources.empty())
+            return nullptr;
+        if (sources.size() == 1)
+            return sources[0];
+        return [sources](const std::string& prefix) {
+            std::vector<std::string> result;
+            for (const auto& source : sources)
+                for (auto& value : source(prefix))
+                    if (std::find(result.begin(), result.end(), value) == result.end())
+                        result.push_back(std::move(value));
+            return result;
+        };
+    }
+
+    INLINE std::vector<std::string> pathCandidates(const std::string& prefix) {
+        namespace fs = std::filesystem;
+        auto slash = prefix.find_last_of('/');
+        std::string dir = slash == std::string::npos ? "" : prefix.substr(0, slash + 1);
+        std::string rest = slash == std::string::npos ? prefix : prefix.substr(slash + 1);
+        std::vector<std::string> result;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir.empty() ? fs::path(".") : fs::path(dir), ec), end; !ec && it != end;
+                it.increment(ec)) {
+            auto name = it->path().filename().string();
+            if (name.compare(0, rest.size(), rest) != 0 || (rest.empty() && name[0] == '.'))
+                continue;
+            std::error_code dirError;
+            result.push_back(dir + name + (it->is_directory(dirError) ? "/" : ""));
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    INLINE std::vector<std::string> ValidatorManager::choices(const std::string &names) const {
+        std::vector<std::string> result;
+        for (const auto& name: split_by_space(names)) {
+            auto it = validators_.find(name);
+            if (it == validators_.end())
+                return {};
+            auto values = it->second->choices();
+            if (values.empty())
+                return {};
+            result.insert(result.end(), values.begin(), values.end());
+        }
+        return result;
+    }
+
     INLINE bool ValidatorManager::validate(const std::string &value, const std::string &names, std::string& found) const {
         found = "";
         auto namesList = split_by_space(names);
@@ -116,7 +188,7 @@ namespace cli {
         if (name[0] == '-' || name.back() == '-')
             return false;
         for (char c : name) {
-            if (!(isalpha(c) || c == '-')) return false;
+            if (!(isAsciiAlpha(c) || c == '-')) return false;
         }
         return true;
     }
@@ -125,6 +197,14 @@ namespace cli {
         return R"([a-z]([a-z-]*[a-z])?)";
     }
 
+    INLINE bool UnicodeIdentifierValidator::validate(const std::string& value, std::string& found) const {
+        found = "";
+        if (!isUnicodeIdentifier(value))
+            return false;
+        found = name();
+        return true;
+    }
+
     INLINE std::string UrlValidator::urlRegexStr() const{
         std::string label = R"([a-z0-9]([a-z0-9-]*[a-z0-9])?)";
         std::string labelDot  = label + R"(\.)";
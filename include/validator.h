@@ -1,10 +1,21 @@
 #pragma once
+#include <functional>
 #include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace cli {
+    /**
+     * @brief Candidate values starting with prefix, for completion; may be slow, it runs on worker thread
+     */
+    using CompletionSource = std::function<std::vector<std::string>(const std::string& prefix)>;
+
+    /**
+     * @brief Entries of directory of prefix whose names continue it, directories end with `/`
+     */
+    std::vector<std::string> pathCandidates(const std::string& prefix);
+
     class Validator {
     protected:
         std::regex urlRegex;
@@ -19,6 +30,16 @@ namespace cli {
         [[nodiscard]] virtual std::vector<std::string> dependencies() const { return {}; }
         [[nodiscard]] virtual std::string description() const { return {}; }
         [[nodiscard]] virtual std::string urlRegexStr() const { return "";}
+        /**
+         * @brief All accepted values when the type is a finite set, for shell completion; empty otherwise
+         */
+        [[nodiscard]] virtual std::vector<std::string> choices() const { return {}; }
+        /**
+         * @brief Source of candidate values, by default filter of choices(); empty when values can't be proposed
+         *
+         * Returned function must not refer to the validator, it can outlive it on background thread.
+         */
+        [[nodiscard]] virtual CompletionSource completionSource() const;
     };
 
     class ValidatorManager {
@@ -33,6 +54,14 @@ namespace cli {
         const Validator& get(const std::string& name) const;
         bool exists(const std::string& name) const;
         bool validate(const std::string& value, const std::string& names, std::string& found) const;
+        /**
+         * @brief Union of choices of types in names, empty when any of them is not finite set
+         */
+        std::vector<std::string> choices(const std::string& names) const;
+        /**
+         * @brief Candidates of all types in names, empty when none of them has a source
+         */
+        CompletionSource completionSource(const std::string& names) const;
         static bool isNameIdentifier(const std::string& name);
     };
 
@@ -45,6 +74,15 @@ namespace cli {
         }
     };
 
+    class UnicodeIdentifierValidator : public Validator {
+    public:
+        [[nodiscard]] std::string name() const override { return "unicode-identifier"; }
+        [[nodiscard]] bool validate(const std::string& value, std::string& found) const override;
+        [[nodiscard]] std::string description() const override {
+            return "letters (also non-ascii), digits or dashes, starts with letter, doesn't end with dash";
+        }
+    };
+
     class UrlValidator : public Validator {
         [[nodiscard]] std::string urlRegexStr() const override;
     public:
@@ -61,6 +99,7 @@ namespace cli {
         [[nodiscard]] std::string description() const override {
             return "Absolute Linux path (starts with /)";
         }
+        [[nodiscard]] CompletionSource completionSource() const override { return pathCandidates; }
     };
 
     class WindowsPathValidator : public Validator {
@@ -70,6 +109,7 @@ namespace cli {
         [[nodiscard]] std::string description() const override {
             return "Windows path like C:\\Program Files";
         }
+        [[nodiscard]] CompletionSource completionSource() const override { return pathCandidates; }
     };
 
     class AutoPathValidator : public Validator {
@@ -82,6 +122,7 @@ namespace cli {
         [[nodiscard]] std::string description() const override {
             return "Platform-specific path (Windows or Linux)";
         }
+        [[nodiscard]] CompletionSource completionSource() const override { return pathCandidates; }
     };
 
     class GeneralPathValidator : public Validator {
@@ -94,6 +135,7 @@ namespace cli {
         [[nodiscard]] std::string description() const override {
             return "One path (Windows or Linux) from both";
         }
+        [[nodiscard]] CompletionSource completionSource() const override { return pathCandidates; }
     };
 
     class IntegerValidator : public Validator {
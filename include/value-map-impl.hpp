@@ -0,0 +1,57 @@
+#pragma once
+#include <functional>
+
+#include "value-map.h"
+
+namespace cli
+{
+    /* slot of key or the empty slot where it would be inserted */
+    INLINE size_t ValueMap::slotOf(std::string_view key) const {
+        size_t mask = m_slots.size() - 1;
+        size_t i = std::hash<std::string_view>{}(key) & mask;
+        while (m_slots[i] != Empty && m_entries[m_slots[i]].key != key)
+            i = (i + 1) & mask;
+        return i;
+    }
+
+    INLINE void ValueMap::rehash(size_t slotCount) {
+        m_slots.assign(slotCount, Empty);
+        for (uint32_t k = 0; k < m_entries.size(); k++)
+            m_slots[slotOf(m_entries[k].key)] = k;
+    }
+
+    INLINE void ValueMap::reserve(size_t n) {
+        m_entries.reserve(n);
+        size_t slotCount = 8;
+        while (slotCount < 2 * n)
+            slotCount *= 2;
+        if (slotCount > m_slots.size())
+            rehash(slotCount);
+    }
+
+    INLINE void ValueMap::set(std::string_view key, std::string_view value) {
+        if (2 * (m_entries.size() + 1) > m_slots.size())
+            rehash(m_slots.empty() ? 8 : 2 * m_slots.size());
+        auto& slot = m_slots[slotOf(key)];
+        if (slot != Empty) {
+            m_entries[slot].value = value;
+            return;
+        }
+        slot = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back(Entry{key, value});
+    }
+
+    INLINE std::optional<std::string_view> ValueMap::find(std::string_view key) const {
+        if (m_slots.empty())
+            return std::nullopt;
+        auto slot = m_slots[slotOf(key)];
+        if (slot == Empty)
+            return std::nullopt;
+        return m_entries[slot].value;
+    }
+
+    INLINE void ValueMap::clear() {
+        m_entries.clear();
+        m_slots.clear();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace cli
+{
+    /**
+     * @brief Flat open-addressing hash map of string views, values of key=value parameter
+     *
+     * Entries are kept in one vector in order of first appearance, later value of the same key
+     * replaces earlier one. Slots are indices into entries, with linear probing over power of
+     * two table, so lookup is one hash and few adjacent compares. Views point to Actual::listBuffer.
+     */
+    class ValueMap
+    {
+    public:
+        struct Entry {
+            std::string_view key;
+            std::string_view value;
+        };
+    private:
+        static constexpr uint32_t Empty = UINT32_MAX;
+        std::vector<Entry> m_entries;
+        std::vector<uint32_t> m_slots;
+        [[nodiscard]] size_t slotOf(std::string_view key) const;
+        void rehash(size_t slotCount);
+    public:
+        void reserve(size_t n);
+        /* inserts or replaces value of key */
+        void set(std::string_view key, std::string_view value);
+        [[nodiscard]] std::optional<std::string_view> find(std::string_view key) const;
+        [[nodiscard]] bool contains(std::string_view key) const { return find(key).has_value(); }
+        [[nodiscard]] size_t size() const { return m_entries.size(); }
+        [[nodiscard]] bool empty() const { return m_entries.empty(); }
+        [[nodiscard]] const Entry* begin() const { return m_entries.data(); }
+        [[nodiscard]] const Entry* end() const { return m_entries.data() + m_entries.size(); }
+        void clear();
+    };
+}
@@ -0,0 +1,3 @@
+#include "completion.h"
+#define INLINE
+#include "completion-impl.hpp"
\ No newline at end of file
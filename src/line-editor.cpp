@@ -0,0 +1,3 @@
+#include "line-editor.h"
+#define INLINE
+#include "line-editor-impl.hpp"
\ No newline at end of file
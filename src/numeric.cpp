@@ -0,0 +1,3 @@
+#include "numeric.h"
+#define INLINE
+#include "numeric-impl.hpp"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include "overlay.h"
+#define INLINE
+#include "overlay-impl.hpp"
\ No newline at end of file
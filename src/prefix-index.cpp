@@ -0,0 +1,3 @@
+#include "prefix-index.h"
+#define INLINE
+#include "prefix-index-impl.hpp"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include "response-file.h"
+#define INLINE
+#include "response-file-impl.hpp"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include "server.h"
+#define INLINE
+#include "server-impl.hpp"
\ No newline at end of file
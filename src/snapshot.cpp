@@ -0,0 +1,3 @@
+#include "snapshot.h"
+#define INLINE
+#include "snapshot-impl.hpp"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include "utf8.h"
+#define INLINE
+#include "utf8-impl.hpp"
\ No newline at end of file
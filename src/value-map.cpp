@@ -0,0 +1,3 @@
+#include "value-map.h"
+#define INLINE
+#include "value-map-impl.hpp"
\ No newline at end of file
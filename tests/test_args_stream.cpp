@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static Command& defineRm(Application& app) {
+    return app.addCommand("rm")
+        .addArg("mode", "identifier")
+        .addArgs("files", "auto-path", 1)
+        .addArgsFrom()
+        .handler([](Actual*) { return 0; });
+}
+
+static std::vector<std::string> drain(ArgumentStream stream) {
+    std::vector<std::string> items;
+    for (const auto& item : stream)
+        items.push_back(item);
+    return items;
+}
+
+TEST(ArgsStreamTest, ArgvOnly) {
+    Application app("test", 1, 1, 1);
+    defineRm(app);
+    app.parse("test rm quiet a.txt b.txt");
+    auto cmd = app.getCommand("rm");
+    ASSERT_EQ(0, cmd->errNumber) << *cmd->errorStr;
+    EXPECT_TRUE(cmd->argsSource.empty());
+    EXPECT_EQ(drain(cmd->streamArguments()), (std::vector<std::string>{"a.txt", "b.txt"}));
+    app.parse("test rm quiet");
+    EXPECT_EQ(ErrorCode::TooFewArguments, cmd->errNumber);
+}
+
+TEST(ArgsStreamTest, StandardInput) {
+    Application app("test", 1, 1, 1);
+    defineRm(app);
+    std::istringstream input("c.txt\n\nd.txt\n");
+    app.argsInput = &input;
+    app.parse("test rm quiet a.txt -");
+    auto cmd = app.getCommand("rm");
+    ASSERT_EQ(0, cmd->errNumber) << *cmd->errorStr;
+    EXPECT_EQ("-", cmd->argsSource);
+    EXPECT_EQ(drain(cmd->streamArguments()), (std::vector<std::string>{"a.txt", "c.txt", "d.txt"}));
+    app.parse("test rm quiet - --args-from list");
+    EXPECT_EQ(ErrorCode::OptionUsedTwice, cmd->errNumber);
+}
+
+TEST(ArgsStreamTest, DashAndArgsFromOnFirstParse) {
+    // each order on fresh application, so no value is left by an earlier parse
+    for (const char* line : {"test rm quiet - --args-from list", "test rm quiet --args-from list -",
+            "test rm quiet - a.txt -"}) {
+        Application app("test", 1, 1, 1);
+        auto& cmd = defineRm(app);
+        app.parse(line);
+        EXPECT_EQ(ErrorCode::OptionUsedTwice, cmd.errNumber) << line;
+    }
+}
+
+TEST(ArgsStreamTest, NulSeparatedFile) {
+    auto path = testing::TempDir() + "clicmd-args.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << std::string("with space.txt\0line\nbreak.txt\0", 30);
+    }
+    Application app("test", 1, 1, 1);
+    defineRm(app);
+    app.parse({"test", "rm", "quiet", "--null", "--args-from", path});
+    auto cmd = app.getCommand("rm");
+    ASSERT_EQ(0, cmd->errNumber) << *cmd->errorStr;
+    EXPECT_EQ(drain(cmd->streamArguments()), (std::vector<std::string>{"with space.txt", "line\nbreak.txt"}));
+
+    app.parse({"test", "rm", "quiet", "--args-from", path + ".missing"});
+    ASSERT_EQ(0, cmd->errNumber);
+    auto stream = cmd->streamArguments();
+    EXPECT_FALSE(stream.next());
+    EXPECT_EQ(ErrorCode::ArgsSourceUnreadable, stream.errNumber());
+    std::remove(path.c_str());
+}
+
+TEST(ArgsStreamTest, InvalidItemStopsStream) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("sum")
+        .addArgs("numbers", "integer", 0)
+        .addArgsFrom()
+        .handler([](Actual*) { return 0; });
+    std::istringstream input("1\n2\nthree\n4\n");
+    app.argsInput = &input;
+    app.parse("test sum -");
+    auto stream = app.getCommand("sum")->streamArguments();
+    std::vector<std::string> items;
+    for (const auto& item : stream)
+        items.push_back(item);
+    EXPECT_EQ(items, (std::vector<std::string>{"1", "2"}));
+    EXPECT_EQ(ErrorCode::IsNotExpectedTypeArg, stream.errNumber());
+    auto again = app.getCommand("sum")->streamArguments();
+    while (again.next()) {}
+    EXPECT_EQ(0, again.errNumber()); // input already consumed
+    EXPECT_THROW(app.addCommand("head").addArgs("files", "auto-path", 0, 10).addArgsFrom(), std::logic_error);
+}
@@ -58,3 +58,29 @@ TEST(CliCmdTest, ArgumentsActualParsing) {
     json actual = app->getCommand("clone")->asJson();
     EXPECT_EQ(expectedActual, actual);
 }
+
+TEST(CliCmdTest, ArgumentsCompactStorage) {
+    cli::Application app("test", 1, 1, 1);
+    app.addCommand("cat")
+        .addArg("first", "string")
+        .addArgs("files", "auto-path", 0)
+        .handler([](const cli::Actual*)->int {return 0;});
+
+    std::vector<std::string> args = {"test", "cat", "a"};
+    for (int i = 0; i < 10000; i++)
+        args.push_back("file" + std::to_string(i) + ".txt");
+    app.parse(args);
+    auto cmd = app.getCommand("cat");
+    ASSERT_EQ(0, cmd->errNumber) << *cmd->errorStr;
+    ASSERT_EQ(10001u, cmd->arguments.size());
+    EXPECT_EQ("first", cmd->arguments[0].argument.name());
+    EXPECT_EQ("a", cmd->arguments[0].value);
+    EXPECT_EQ("files", cmd->arguments[1].argument.name());
+    EXPECT_EQ("file9999.txt", cmd->arguments[10000].value);
+    // all variadic values share one formal
+    EXPECT_EQ(&cmd->arguments[1].argument, &cmd->arguments[10000].argument);
+    size_t n = 0;
+    for (auto v : cmd->arguments)
+        n += v.value.size();
+    EXPECT_GT(n, 10000u);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static void defineSchema(Application& app) {
+    app.addCommand("clone")
+        .addArg("repository", "url")
+        .addFlag("--verbose", "-v", "be more verbose")
+        .addParameter("--depth", "", "Create a shallow clone", "integer")
+        .handler([](Actual*) { return 0; });
+    app.addCommand("remote", "Manage remotes", [](Command& cmd) {
+        cmd.addCommand("add").addArg("name", "identifier").addArg("url", "url")
+            .handler([](Actual*) { return 0; });
+    });
+}
+
+TEST(BatchTest, ResultsInLineOrder) {
+    Application app("test", 1, 1, 1);
+    defineSchema(app);
+    app.parse("test clone https://example.com/a.git");
+    std::vector<std::string> script;
+    for (int i = 0; i < 1000; i++)
+        script.push_back(i % 10 == 7 ? "clone --depth x https://example.com/a.git"
+            : "clone -v --depth " + std::to_string(i) + " https://example.com/a.git");
+    script.emplace_back("remote add origin https://example.com/o.git");
+    script.emplace_back("clne https://example.com/a.git");
+    script.emplace_back("help clone");
+    script.emplace_back("");
+    std::vector<std::string_view> lines(script.begin(), script.end());
+    auto results = app.parseBatch(lines, 4);
+    ASSERT_EQ(lines.size(), results.size());
+    auto clone = app.getCommand("clone").get();
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(clone, results[i].command);
+        EXPECT_EQ(i % 10 == 7 ? ErrorCode::IsNotExpectedTypeParam : 0, results[i].errNumber) << i;
+        EXPECT_EQ(i % 10 == 7, !results[i].errorStr.empty());
+    }
+    EXPECT_EQ(0, results[1000].errNumber) << results[1000].errorStr;
+    EXPECT_EQ(app.getCommand("remote")->findSubcommand("add").get(), results[1000].command);
+    EXPECT_EQ(nullptr, results[1001].command);
+    EXPECT_EQ(ErrorCode::UnknownCommand, results[1001].errNumber);
+    EXPECT_EQ(0, results[1002].errNumber);
+    EXPECT_EQ(0, results[1003].errNumber);
+    // actual data of commands is untouched
+    EXPECT_EQ(app.currentCommand.get(), clone);
+    EXPECT_EQ("https://example.com/a.git", clone->arguments[0].value);
+    EXPECT_FALSE(clone->containsFlag("--verbose"));
+}
+
+TEST(BatchTest, SingleThreadMatchesParallel) {
+    Application app("test", 1, 1, 1);
+    defineSchema(app);
+    std::vector<std::string_view> lines = {"clone", "clone a b", "clone -x https://e.com/r.git", "remote add o"};
+    auto serial = app.parseBatch(lines, 1);
+    auto parallel = app.parseBatch(lines, 8);
+    for (size_t i = 0; i < lines.size(); i++) {
+        EXPECT_NE(0, serial[i].errNumber);
+        EXPECT_EQ(serial[i].errNumber, parallel[i].errNumber);
+        EXPECT_EQ(serial[i].errorStr, parallel[i].errorStr);
+    }
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static std::vector<StaticOption> machineOptions(size_t n) {
+    static std::vector<std::string> names;
+    names.clear();
+    for (size_t i = 0; i < n; i++)
+        names.push_back("-mopt" + std::to_string(i));
+    std::vector<StaticOption> options;
+    for (const auto& name : names)
+        options.push_back(flag(name, "", "machine option"));
+    return options;
+}
+
+TEST(BulkTest, ManyOptionsOnMainCommand) {
+    Application app("test", 0, 0, 1);
+    app.mainCommand->addArgs("files", "path", 1);
+    app.mainCommand->addOptions(machineOptions(10000));
+    app.mainCommand->addOptions({
+        parameter("-o", "", "Output file", "path"),
+        defParameter("--jobs", "-j", "Number of jobs", "integer", "1"),
+    });
+    app.freeze();
+    app.parse("test -mopt42 -mopt9999 -o out main.c");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_TRUE(cmd->containsFlag("-mopt42"));
+    EXPECT_TRUE(cmd->containsFlag("-mopt9999"));
+    EXPECT_EQ(cmd->getValue("-o"), std::optional<std::string>("out"));
+    EXPECT_EQ(cmd->getValue("--jobs"), std::optional<std::string>("1"));
+}
+
+TEST(BulkTest, CommandsAreCheckedAtFirstParse) {
+    const StaticOption cloneOptions[] = {
+        flag("--verbose", "-v", "be more verbose"),
+    };
+    const StaticArgument cloneArguments[] = {
+        arg("repository", "url"),
+    };
+    Application app("test", 1, 1, 1);
+    app.addOptions({flag("--quiet", "-q", "be quiet")});
+    app.addCommands({
+        {"clone", "Clone a repository", cloneOptions, 1, cloneArguments, 1, nullptr},
+        {"init", "Create a repository", nullptr, 0, nullptr, 0, nullptr},
+    });
+    app.parse("test clone -vq https://example.com/repo.git");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(ErrorCode::MissingHandler, cmd->errNumber);
+    EXPECT_TRUE(cmd->containsFlag("--verbose"));
+    EXPECT_TRUE(cmd->containsFlag("--quiet"));
+    EXPECT_EQ(1u, cmd->arguments.size());
+    EXPECT_THROW(app.addOptions({flag("--color", "", "colorize")}), std::logic_error);
+}
+
+TEST(BulkTest, DuplicateOptionRejectedAtFreeze) {
+    Application app("test", 1, 1, 1);
+    auto& cmd = app.addCommand("build");
+    cmd.addOptions({flag("--release", "-r", "release"), flag("--debug", "-d", "debug")});
+    cmd.addOptions({flag("--release", "", "release again")});
+    EXPECT_THROW(app.freeze(), std::invalid_argument);
+}
+
+TEST(BulkTest, LocalOptionShadowingPendingGlobalRejectedAtFreeze) {
+    {
+        Application app("test", 1, 1, 1);
+        app.addOptions({flag("--verbose", "", "be verbose")});
+        app.addCommand("x").addFlag("--verbose", "", "local verbose");
+        EXPECT_THROW(app.freeze(), std::invalid_argument);
+    }
+    {
+        Application app("test", 1, 1, 1);
+        app.addOptions({flag("--verbose", "", "be verbose")});
+        app.addCommand("remote").addCommand("add").addParameter("--verbose", "", "local verbose", "string");
+        EXPECT_THROW(app.freeze(), std::invalid_argument);
+    }
+}
+
+TEST(BulkTest, FailedCheckLeavesSchemaUnchanged) {
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommands({
+            {"clone", "Clone a repository", nullptr, 0, nullptr, 0, nullptr},
+            {"clone", "Clone again", nullptr, 0, nullptr, 0, nullptr},
+            {"init", "Create a repository", nullptr, 0, nullptr, 0, nullptr},
+        });
+        EXPECT_THROW(app.parse("test init"), std::runtime_error);
+        EXPECT_THROW(app.parse("test init"), std::runtime_error);
+    }
+    {
+        Application app("test", 1, 1, 1);
+        app.addOptions({flag("--quiet", "-q", "be quiet")});
+        app.addCommand("x").addFlag("--quiet", "", "local quiet");
+        EXPECT_THROW(app.parse("test x --quiet"), std::invalid_argument);
+        EXPECT_THROW(app.parse("test x --quiet"), std::invalid_argument);
+    }
+}
+
+TEST(BulkTest, ShorthandConflictRejectedAtFreeze) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("build").addFlag("--release", "-r", "release");
+    app.addCommand("test").addOptions({flag("--repeat", "-r", "repeat")});
+    EXPECT_THROW(app.freeze(), std::invalid_argument);
+}
+
+TEST(BulkTest, BadNamesRejectedAtFreeze) {
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommands({{"bad-", "", nullptr, 0, nullptr, 0, nullptr}});
+        EXPECT_THROW(app.freeze(), std::invalid_argument);
+    }
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommand("build").addOptions({flag("release", "", "release")});
+        EXPECT_THROW(app.freeze(), std::invalid_argument);
+    }
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommand("build");
+        app.addCommands({{"build", "", nullptr, 0, nullptr, 0, nullptr}});
+        EXPECT_THROW(app.freeze(), std::runtime_error);
+    }
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static std::vector<std::string> values(const std::vector<CompletionCandidate>& candidates) {
+    std::vector<std::string> result;
+    for (const auto& candidate : candidates)
+        result.push_back(candidate.value);
+    return result;
+}
+
+static void defineSchema(Application& app) {
+    app.addFlag("--quiet", "-q", "Print nothing");
+    auto* category = app.addCategory("work on the current change");
+    category->addCommand("clone").desc("Clone a repository")
+        .addArg("repository", "url")
+        .addFlag("--verbose", "-v", "be more verbose")
+        .addParameter("--depth", "-d", "Create a shallow clone", "integer")
+        .addListParameter("--config", "-c", "Set configuration", "string")
+        .handler([](Actual*) { return 0; });
+    app.addCommand("commit").desc("Record changes").handler([](Actual*) { return 0; });
+    app.addCommand("remote", "Manage remotes", [](Command& cmd) {
+        cmd.addCommand("add").desc("Add remote").addArg("name", "identifier").handler([](Actual*) { return 0; });
+        cmd.addCommand("remove").desc("Remove remote").addArg("name", "identifier").handler([](Actual*) { return 0; });
+    });
+}
+
+TEST(CompleteTest, CommandsAndOptions) {
+    Application app("test", 2, 1, 1);
+    defineSchema(app);
+    auto candidates = app.complete({"test", "c"}, 1);
+    ASSERT_EQ((std::vector<std::string>{"clone", "commit"}), values(candidates));
+    EXPECT_EQ("Clone a repository", candidates[0].description);
+    EXPECT_EQ("work on the current change", candidates[0].group);
+    EXPECT_EQ("", candidates[1].group);
+    EXPECT_EQ((std::vector<std::string>{"clone", "commit", "help", "remote"}), values(app.complete({"test"}, 1)));
+    EXPECT_EQ((std::vector<std::string>{"remote"}), values(app.complete({"test", "help", "r"}, 2)));
+
+    EXPECT_EQ((std::vector<std::string>{"--config", "--depth", "--quiet", "--verbose"}),
+        values(app.complete({"test", "clone", "--"}, 2)));
+    // used options are not offered again, repeatable ones are
+    EXPECT_EQ((std::vector<std::string>{"--config", "--quiet"}),
+        values(app.complete({"test", "clone", "-v", "--depth", "1", "-c", "x", "--"}, 7)));
+    EXPECT_EQ((std::vector<std::string>{"--config", "--depth", "--quiet", "--verbose", "-c", "-d", "-q", "-v"}),
+        values(app.complete({"test", "clone", "-"}, 2)));
+    EXPECT_EQ((std::vector<std::string>{"-v"}), values(app.complete({"test", "clone", "-v"}, 2)));
+    EXPECT_EQ((std::vector<std::string>{"remove"}), values(app.complete({"test", "remote", "rem", "x"}, 2)));
+    EXPECT_TRUE(app.complete({"test", "clone", "--depth", ""}, 3).empty());
+}
+
+TEST(CompleteTest, HiddenProtocol) {
+    Application app("test", 1, 1, 1);
+    defineSchema(app);
+    testing::internal::CaptureStdout();
+    app.parse(std::vector<std::string>{"test", "__complete", "2", "test", "clone", "--d"});
+    EXPECT_EQ(0, app.execute());
+    EXPECT_EQ("--depth\tCreate a shallow clone\n:url\n", testing::internal::GetCapturedStdout());
+    testing::internal::CaptureStdout();
+    app.parse(std::vector<std::string>{"test", "__complete", "3", "test", "clone", "--depth"});
+    EXPECT_EQ(0, app.execute());
+    EXPECT_EQ(":integer\n", testing::internal::GetCapturedStdout());
+    app.parse(std::vector<std::string>{"test", "__complete", "x"});
+    EXPECT_EQ(1, app.execute());
+}
+
+TEST(CompleteTest, LargeSchemaUsesIndex) {
+    Application app("test", 1, 1, 1);
+    for (int i = 0; i < 5000; i++)
+        app.addCommand("cmd" + std::to_string(i)).desc("Command").addFlag("--flag" + std::to_string(i % 7), "", "Flag");
+    EXPECT_EQ(5000u, app.complete({"test", "cmd"}, 1).size());
+    EXPECT_EQ(111u, app.complete({"test", "cmd42"}, 1).size()); // cmd42, cmd420..cmd4299
+    EXPECT_EQ((std::vector<std::string>{"--flag0"}), values(app.complete({"test", "cmd4221", "--f"}, 2)));
+}
+
+struct ColorValidator : Validator {
+    [[nodiscard]] std::string name() const override { return "color"; }
+    [[nodiscard]] bool validate(const std::string& value, std::string& found) const override {
+        found = "color";
+        return value == "red" || value == "green";
+    }
+    [[nodiscard]] std::vector<std::string> choices() const override { return {"red", "green"}; }
+};
+
+TEST(CompleteTest, StaticScripts) {
+    Application app("my-tool", 1, 1, 1);
+    ValidatorManager::instance().register_validator(std::make_unique<ColorValidator>());
+    defineSchema(app);
+    app.getCommand("clone")->addParameter("--color", "", "Color 'of' output", "color");
+    auto bash = app.completionScript(CompletionShell::Bash);
+    EXPECT_NE(std::string::npos, bash.find("\"0 remote\") _my_tool_r=3 ;;"));
+    EXPECT_NE(std::string::npos, bash.find("\"3 add\") _my_tool_r=4 ;;"));
+    EXPECT_NE(std::string::npos, bash.find("\"1 -d\") _my_tool_r=\"integer\" ;;"));
+    EXPECT_NE(std::string::npos, bash.find("\"color\") _my_tool_r=\"red green\" ;;"));
+    EXPECT_NE(std::string::npos, bash.find("complete -F _my_tool_complete my-tool"));
+    auto zsh = app.completionScript(CompletionShell::Zsh);
+    EXPECT_EQ(0u, zsh.find("#compdef my-tool\n"));
+    EXPECT_NE(std::string::npos, zsh.find("'--color:Color '\\''of'\\'' output'"));
+    auto fish = app.completionScript(CompletionShell::Fish);
+    EXPECT_NE(std::string::npos, fish.find("printf '%s\\t%s\\n' '--color' 'Color \\'of\\' output'"));
+    EXPECT_NE(std::string::npos, fish.find("complete -c my-tool -f -a '(_my_tool_complete)'"));
+}
+
+struct BranchValidator : Validator {
+    std::shared_ptr<std::atomic<int>> calls = std::make_shared<std::atomic<int>>(0);
+    [[nodiscard]] std::string name() const override { return "branch"; }
+    [[nodiscard]] bool validate(const std::string&, std::string& found) const override {
+        found = "branch";
+        return true;
+    }
+    [[nodiscard]] CompletionSource completionSource() const override {
+        auto counter = calls;
+        return [counter](const std::string& prefix) {
+            ++*counter;
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            std::vector<std::string> result;
+            for (std::string branch : {"main", "master", "topic"})
+                if (branch.compare(0, prefix.size(), prefix) == 0)
+                    result.push_back(branch);
+            return result;
+        };
+    }
+};
+
+TEST(CompleteTest, ValueSources) {
+    auto dir = std::filesystem::temp_directory_path() / ("clicmd-values-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    std::filesystem::remove_all(dir);
+    {
+        Application app("test", 1, 1, 1);
+        ValidatorManager::instance().register_validator(std::make_unique<ColorValidator>());
+        auto branches = std::make_unique<BranchValidator>();
+        auto calls = branches->calls;
+        ValidatorManager::instance().register_validator(std::move(branches));
+        app.valueCompleter.cacheDir = dir.string();
+        defineSchema(app);
+        app.getCommand("clone")->addParameter("--color", "", "Color of output", "color")
+            .addParameter("--branch", "-b", "Branch to check out", "branch");
+        // choices are answered at once, and are not written to disk
+        EXPECT_EQ((std::vector<std::string>{"green"}), values(app.complete({"test", "clone", "--color", "g"}, 3)));
+        EXPECT_EQ((std::vector<std::string>{"red", "green"}), values(app.complete({"test", "clone", "--color", ""}, 3)));
+        // slow source misses budget, keeps running and fills the cache
+        EXPECT_TRUE(app.complete({"test", "clone", "-b", "ma"}, 3).empty());
+        EXPECT_TRUE(app.valueCompleter.pending());
+        EXPECT_TRUE(app.valueCompleter.wait(std::chrono::seconds(5)));
+        EXPECT_EQ((std::vector<std::string>{"main", "master"}), values(app.complete({"test", "clone", "-b", "ma"}, 3)));
+        EXPECT_EQ(1, calls->load());
+        EXPECT_EQ(1, std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()));
+    }
+    {
+        // one-shot __complete leaves slow source to detached process, which fills the cache
+        Application app("test", 1, 1, 1);
+        auto branches = std::make_unique<BranchValidator>();
+        auto calls = branches->calls;
+        ValidatorManager::instance().register_validator(std::move(branches));
+        app.valueCompleter.cacheDir = dir.string();
+        app.addCommand("checkout").addArg("branch", "branch").handler([](Actual*) { return 0; });
+        testing::internal::CaptureStdout();
+        app.parse(std::vector<std::string>{"test", "__complete", "2", "test", "checkout", "to"});
+        EXPECT_EQ(0, app.execute());
+        EXPECT_EQ(":branch\n", testing::internal::GetCapturedStdout());
+        EXPECT_TRUE(app.valueCompleter.pending());
+        EXPECT_TRUE(app.valueCompleter.wait(std::chrono::seconds(5)));
+        EXPECT_EQ((std::vector<std::string>{"topic"}), values(app.complete({"test", "checkout", "to"}, 2)));
+        EXPECT_EQ(0, calls->load()); // not run by this process
+        EXPECT_EQ(2, std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()));
+    }
+    {
+        // cache on disk serves next process
+        Application app("test", 1, 1, 1);
+        auto branches = std::make_unique<BranchValidator>();
+        auto calls = branches->calls;
+        ValidatorManager::instance().register_validator(std::move(branches));
+        app.valueCompleter.cacheDir = dir.string();
+        app.addCommand("checkout").addArg("branch", "branch").handler([](Actual*) { return 0; });
+        EXPECT_EQ((std::vector<std::string>{"main", "master"}), values(app.complete({"test", "checkout", "ma"}, 2)));
+        EXPECT_EQ(0, calls->load());
+        // stale values are returned while source refreshes them
+        app.valueCompleter.ttl = std::chrono::seconds(-1);
+        EXPECT_EQ((std::vector<std::string>{"main", "master"}), values(app.complete({"test", "checkout", "ma"}, 2)));
+        EXPECT_TRUE(app.valueCompleter.wait(std::chrono::seconds(5)));
+        EXPECT_EQ(1, calls->load());
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST(CompleteTest, PathCandidates) {
+    auto dir = std::filesystem::temp_directory_path() / ("clicmd-paths-" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "src");
+    std::ofstream(dir / "setup.cfg").put('\n');
+    std::ofstream(dir / ".hidden").put('\n');
+    auto base = dir.string() + "/";
+    EXPECT_EQ((std::vector<std::string>{base + "setup.cfg", base + "src/"}), pathCandidates(base));
+    EXPECT_EQ((std::vector<std::string>{base + ".hidden"}), pathCandidates(base + "."));
+    EXPECT_EQ((std::vector<std::string>{base + "src/"}), pathCandidates(base + "sr"));
+    EXPECT_TRUE(pathCandidates(base + "missing/").empty());
+    std::filesystem::remove_all(dir);
+}
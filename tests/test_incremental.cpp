@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static void defineSchema(Application& app) {
+    app.addCommand("clone")
+        .addArg("repository", "url")
+        .addArgs("directory", "auto-path", 0, 1)
+        .addFlag("--verbose", "-v", "be more verbose")
+        .addParameter("--depth", "-d", "Create a shallow clone", "integer")
+        .handler([](Actual*) { return 0; });
+    app.addCommand("remote", "Manage remotes", [](Command& cmd) {
+        cmd.addCommand("add").addArg("name", "identifier").addArg("url", "url")
+            .handler([](Actual*) { return 0; });
+    });
+}
+
+TEST(IncrementalTest, ExpectationFollowsLine) {
+    Application app("test", 1, 1, 1);
+    defineSchema(app);
+    IncrementalParser parser(app);
+    EXPECT_EQ(ExpectKind::Command, parser.expected().kind);
+    auto clone = app.getCommand("clone").get();
+
+    auto& e = parser.update("cl");
+    EXPECT_EQ(ExpectKind::Command, e.kind);
+    EXPECT_EQ("cl", e.partial);
+
+    parser.update("clone -v --depth ");
+    EXPECT_EQ(ExpectKind::Value, e.kind);
+    EXPECT_EQ(clone, e.command);
+    EXPECT_EQ("integer", e.parameter->expectType());
+    EXPECT_TRUE(parser.used("--verbose"));
+
+    parser.update("clone -v --depth 3 https://e.com/r.git ");
+    EXPECT_EQ(ExpectKind::Token, e.kind);
+    EXPECT_EQ(1u, e.positional);
+    EXPECT_EQ("directory", e.argument->name());
+    EXPECT_EQ(3u, parser.reusedTokens());
+
+    parser.update("clone -v --depth 3 https://e.com/r.git dir ");
+    EXPECT_EQ(nullptr, e.argument);
+
+    // edit in the middle drops states after it
+    parser.update("clone -d 3 'a b");
+    EXPECT_EQ(1u, parser.reusedTokens());
+    EXPECT_FALSE(parser.used("--verbose"));
+    EXPECT_TRUE(parser.used("--depth"));
+    EXPECT_EQ("a b", e.partial);
+    EXPECT_EQ("repository", e.argument->name());
+}
+
+TEST(IncrementalTest, NestedHelpAndUnknown) {
+    Application app("test", 1, 1, 1);
+    defineSchema(app);
+    IncrementalParser parser(app);
+    auto& e = parser.update("remote add origin ");
+    EXPECT_EQ(ExpectKind::Token, e.kind);
+    EXPECT_EQ(app.getCommand("remote")->findSubcommand("add").get(), e.command);
+    EXPECT_EQ("url", e.argument->name());
+
+    parser.update("help ");
+    EXPECT_EQ(ExpectKind::Command, e.kind);
+    EXPECT_TRUE(e.help);
+
+    parser.update("clnoe -v ");
+    EXPECT_EQ(ExpectKind::Nothing, e.kind);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <streambuf>
+#include <thread>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static void defineFetch(Application& app, std::atomic<int>& running, std::atomic<int>& peak) {
+    app.addJobsOption();
+    app.addCommand("fetch")
+        .addArgs("urls", "string", 1)
+        .itemHandler([&](const Actual*, const std::string& item, std::ostream& out) {
+            int now = ++running;
+            int seen = peak;
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+            // later items finish first, output must still come in order
+            std::this_thread::sleep_for(std::chrono::milliseconds(item == "a" ? 30 : 5));
+            out << "fetched " << item << "\n";
+            --running;
+            return item == "bad" ? 4 : 0;
+        });
+}
+
+TEST(ItemHandlerTest, ParallelInOrder) {
+    std::atomic<int> running{0}, peak{0};
+    Application app("test", 1, 1, 1);
+    defineFetch(app, running, peak);
+    app.parse("test fetch -j 3 a b c d");
+    testing::internal::CaptureStdout();
+    int code = app.execute();
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(0, code);
+    EXPECT_EQ("fetched a\nfetched b\nfetched c\nfetched d\n", out);
+    EXPECT_LE(peak.load(), 3);
+    EXPECT_GE(peak.load(), 2);
+}
+
+TEST(ItemHandlerTest, FirstFailureIsExitCode) {
+    std::atomic<int> running{0}, peak{0};
+    Application app("test", 1, 1, 1);
+    defineFetch(app, running, peak);
+    app.parse("test fetch --jobs 1 a bad c");
+    testing::internal::CaptureStdout();
+    int code = app.execute();
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(4, code);
+    EXPECT_EQ("fetched a\nfetched bad\nfetched c\n", out);
+    EXPECT_EQ(1, peak.load());
+}
+
+TEST(ItemHandlerTest, ExceptionIsRethrown) {
+    Application app("test", 1, 1, 1);
+    app.addJobsOption();
+    app.addCommand("check")
+        .addArgs("items", "string", 1)
+        .itemHandler([](const Actual*, const std::string& item, std::ostream&) -> int {
+            if (item == "x")
+                throw std::runtime_error("failed " + item);
+            return 0;
+        });
+    app.parse("test check a x b -j 2");
+    testing::internal::CaptureStdout();
+    EXPECT_THROW(app.execute(), std::runtime_error);
+    testing::internal::GetCapturedStdout();
+}
+
+/* endless-looking input: lines "0\n", "1\n", ... made one at a time, so reads can be counted */
+class CountingLines : public std::streambuf {
+    std::string m_line;
+    int m_total;
+public:
+    std::atomic<int> produced{0};
+    explicit CountingLines(int total): m_total(total) {}
+protected:
+    int_type underflow() override {
+        if (produced == m_total)
+            return traits_type::eof();
+        m_line = std::to_string(produced++) + "\n";
+        setg(m_line.data(), m_line.data(), m_line.data() + m_line.size());
+        return traits_type::to_int_type(m_line[0]);
+    }
+};
+
+TEST(ItemHandlerTest, StreamIsReadInBoundedWindow) {
+    CountingLines lines(2000);
+    std::istream input(&lines);
+    std::atomic<int> maxAhead{0};
+    Application app("test", 1, 1, 1);
+    app.addJobsOption();
+    app.addCommand("fetch")
+        .addArgs("urls", "string", 0)
+        .addArgsFrom()
+        .itemHandler([&](const Actual*, const std::string& item, std::ostream& out) {
+            int ahead = lines.produced - std::stoi(item);
+            int seen = maxAhead;
+            while (ahead > seen && !maxAhead.compare_exchange_weak(seen, ahead)) {}
+            out << item << "\n";
+            return 0;
+        });
+    app.argsInput = &input;
+    app.parse("test fetch -j 2 --args-from -");
+    testing::internal::CaptureStdout();
+    EXPECT_EQ(0, app.execute());
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(2000, std::count(out.begin(), out.end(), '\n'));
+    EXPECT_EQ(0u, out.find("0\n1\n2\n"));
+    EXPECT_EQ(out.size() - 5, out.rfind("1999\n"));
+    EXPECT_LE(maxAhead.load(), 2 * 4 + 1);
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+TEST(LazyCommandsTest, FactoryRunsOnDispatchOnly) {
+    Application app("test", 2, 1, 1);
+    int built = 0;
+    auto* category = app.addCategory("remote");
+    category->addCommand("fetch", "Download objects", [&built](Command& cmd) {
+        built++;
+        cmd.addFlag("--all", "-a", "Fetch all remotes")
+            .addArgs("remote", "identifier", 0, 1)
+            .handler([](Actual*) { return 4; });
+    });
+    app.addCommand("push", "Update remote refs", [&built](Command& cmd) {
+        built++;
+        cmd.addFlag("--force", "-f", "Force update");
+    });
+    EXPECT_EQ(0, built);
+
+    app.parse("test fetch -a origin");
+    EXPECT_EQ(1, built);
+    ASSERT_EQ(0, app.currentCommand->errNumber);
+    EXPECT_TRUE(app.currentCommand->containsFlag("--all"));
+    EXPECT_EQ(4, app.execute());
+
+    app.parse("test fetch");
+    EXPECT_EQ(1, built);
+
+    testing::internal::CaptureStdout();
+    app.parse("test help push");
+    app.execute();
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(2, built);
+    EXPECT_NE(std::string::npos, out.find("--force"));
+}
+
+TEST(LazyCommandsTest, HelpListingDoesNotMaterialize) {
+    Application app("test", 1, 1, 1);
+    bool built = false;
+    app.addCommand("status", "Show the working tree status", [&built](Command&) { built = true; });
+    testing::internal::CaptureStdout();
+    app.parse("test help");
+    app.execute();
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_FALSE(built);
+    EXPECT_NE(std::string::npos, out.find("Show the working tree status"));
+}
+
+TEST(LazyCommandsTest, FailedFactoryRunsAgain) {
+    Application app("test", 1, 1, 1);
+    int attempts = 0;
+    app.addCommand("push", "Update remote refs", [&attempts](Command& cmd) {
+        cmd.addFlag("--force", "-f", "Force update");
+        if (++attempts == 1)
+            throw std::runtime_error("remotes unavailable");
+        cmd.handler([](Actual*) { return 3; });
+    });
+    EXPECT_THROW(app.parse("test push -f"), std::runtime_error);
+    app.parse("test push -f");
+    EXPECT_EQ(2, attempts);
+    ASSERT_EQ(0, app.currentCommand->errNumber);
+    EXPECT_TRUE(app.currentCommand->containsFlag("--force"));
+    EXPECT_EQ(3, app.execute());
+}
+
+TEST(LazyCommandsTest, FactoryRunsAfterFreeze) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("tag", "Create a tag", [](Command& cmd) {
+        cmd.addArg("name", "identifier");
+    });
+    app.freeze();
+    app.parse("test tag release");
+    EXPECT_EQ(ErrorCode::MissingHandler, app.currentCommand->errNumber);
+    EXPECT_EQ(1u, app.currentCommand->arguments.size());
+    EXPECT_THROW(app.getCommand("tag")->addFlag("--sign", "-s", "sign"), std::logic_error);
+}
+
+TEST(LazyCommandsTest, FactoryChangesOnlyItsCommand) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("init");
+    bool otherChanged = true, appChanged = true;
+    app.addCommand("remote", "Manage remotes", [&](Command& cmd) {
+        cmd.addCommand("add").addArg("name", "identifier").addFlag("--fetch", "-f", "Fetch at once");
+        otherChanged = appChanged = false;
+        try {
+            app.getCommand("init")->addFlag("--bare", "", "Bare repository");
+            otherChanged = true;
+        } catch (const std::logic_error&) {}
+        try {
+            app.addCommand("clone");
+            appChanged = true;
+        } catch (const std::logic_error&) {}
+    });
+    app.freeze();
+    app.parse("test remote add -f origin");
+    EXPECT_FALSE(otherChanged);
+    EXPECT_FALSE(appChanged);
+    EXPECT_TRUE(app.isFrozen());
+    EXPECT_TRUE(app.currentCommand->containsFlag("--fetch"));
+    EXPECT_THROW(app.getCommand("remote")->addFlag("--verbose", "-v", "verbose"), std::logic_error);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static std::vector<std::string> values(const std::shared_ptr<Command>& actual, const std::string& key) {
+    std::vector<std::string> result;
+    for (auto value : actual->getValues(key))
+        result.emplace_back(value);
+    return result;
+}
+
+TEST(ListParameterTest, ValuesInCommandLineOrder) {
+    Application app("test", 0, 0, 1);
+    auto cmd = app.mainCommand;
+    cmd->addArgs("files", "path", 0);
+    cmd->addListParameter("--include", "-i", "Add include directory", "path");
+    cmd->addListParameter("-Xlinker", "", "Pass to linker", "string");
+    cmd->addParameter("-o", "", "Output", "path");
+    app.parse("test -i a --include b -Xlinker -rpath -i c -Xlinker /opt main.c");
+    auto actual = app.currentCommand;
+    ASSERT_EQ(0, actual->errNumber) << *actual->errorStr;
+    EXPECT_EQ(values(actual, "--include"), (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_EQ(values(actual, "-Xlinker"), (std::vector<std::string>{"-rpath", "/opt"}));
+    EXPECT_EQ(actual->getValue("--include"), std::optional<std::string>("c"));
+    EXPECT_TRUE(actual->getValues("-o").empty());
+    auto span = actual->getValues("--include");
+    ASSERT_EQ(3u, span.size());
+    EXPECT_EQ("b", span[1]);
+    // one range of the shared vector per parameter
+    EXPECT_EQ(span.end(), actual->getValues("--include").begin() + 3);
+}
+
+TEST(ListParameterTest, OrdinaryParameterStillOnce) {
+    Application app("test", 0, 0, 1);
+    app.mainCommand->addListParameter("--define", "-D", "Define macro", "string");
+    app.mainCommand->addParameter("-o", "", "Output", "path");
+    app.parse("test -o a -o b");
+    EXPECT_EQ(ErrorCode::OptionUsedTwice, app.currentCommand->errNumber);
+    app.parse("test -D X --define Y=1");
+    ASSERT_EQ(0, app.currentCommand->errNumber);
+    EXPECT_EQ(values(app.currentCommand, "--define"), (std::vector<std::string>{"X", "Y=1"}));
+    app.parse("test -o a");
+    EXPECT_TRUE(app.currentCommand->getValues("--define").empty());
+}
+
+TEST(ListParameterTest, RepeatablePrefixFamily) {
+    Application app("test", 0, 0, 1);
+    auto cmd = app.mainCommand;
+    cmd->addPrefixParameter("-I", "Add include directory", "path", true);
+    cmd->addPrefixParameter("-O", "Optimization level", "string");
+    app.freeze();
+    app.parse("test -I/usr/include -O2 -Ilocal");
+    auto actual = app.currentCommand;
+    ASSERT_EQ(0, actual->errNumber) << *actual->errorStr;
+    EXPECT_EQ(values(actual, "-I"), (std::vector<std::string>{"/usr/include", "local"}));
+    app.parse("test -O2 -O3");
+    EXPECT_EQ(ErrorCode::OptionUsedTwice, app.currentCommand->errNumber);
+}
+
+TEST(ListParameterTest, JsonAndSnapshot) {
+    std::vector<char> image;
+    {
+        Application app("test", 1, 0, 1);
+        app.addCommand("build").addListParameter("--tag", "-t", "Tag", "string")
+            .handler([](Actual*) { return 0; });
+        app.parse("test build -t x -t y");
+        json j = *app.currentCommand;
+        EXPECT_EQ(j["list_map"]["--tag"], json::array({"x", "y"}));
+        image = app.snapshotImage();
+    }
+    Application app("test", 1, 0, 1);
+    app.loadSnapshot(Snapshot::fromBytes(image));
+    app.getCommand("build")->handler([](Actual*) { return 0; });
+    app.parse("test build --tag x --tag y");
+    ASSERT_EQ(0, app.currentCommand->errNumber);
+    EXPECT_EQ(values(app.currentCommand, "--tag"), (std::vector<std::string>{"x", "y"}));
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+TEST(MapParameterTest, PairsAreSplitAndLastWins) {
+    Application app("test", 0, 0, 1);
+    app.mainCommand->addMapParameter("--set", "-s", "Override config value");
+    app.mainCommand->addMapParameter("--define", "-D", "Define macro");
+    app.parse("test --set a.b=1 -D NDEBUG -s c=x=y --set a.b=2 -D LEVEL=3");
+    auto actual = app.currentCommand;
+    ASSERT_EQ(0, actual->errNumber) << *actual->errorStr;
+    const auto& set = actual->getMap("--set");
+    EXPECT_EQ(2u, set.size());
+    EXPECT_EQ(std::optional<std::string_view>("2"), set.find("a.b"));
+    EXPECT_EQ(std::optional<std::string_view>("x=y"), set.find("c"));
+    EXPECT_EQ(std::nullopt, set.find("a"));
+    const auto& define = actual->getMap("--define");
+    EXPECT_TRUE(define.contains("NDEBUG"));
+    EXPECT_EQ(std::optional<std::string_view>(""), define.find("NDEBUG"));
+    EXPECT_EQ("LEVEL", define.begin()[1].key);
+    EXPECT_TRUE(actual->getMap("--other").empty());
+    // every token is also kept as list value
+    EXPECT_EQ(3u, actual->getValues("--set").size());
+}
+
+TEST(MapParameterTest, BadPairs) {
+    Application app("test", 0, 0, 1);
+    app.mainCommand->addMapParameter("--jobs", "-j", "Jobs per pool", "integer");
+    app.parse("test -j =4");
+    EXPECT_EQ(ErrorCode::BadKeyValue, app.currentCommand->errNumber);
+    app.parse("test -j build=many");
+    EXPECT_EQ(ErrorCode::IsNotExpectedTypeParam, app.currentCommand->errNumber);
+    app.parse("test -j build=4 --jobs test=8");
+    ASSERT_EQ(0, app.currentCommand->errNumber);
+    EXPECT_EQ(std::optional<std::string_view>("8"), app.currentCommand->getMap("--jobs").find("test"));
+    json j = *app.currentCommand;
+    EXPECT_EQ("4", j["map_values"]["--jobs"]["build"]);
+}
+
+TEST(MapParameterTest, ManyKeys) {
+    ValueMap map;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1000; i++)
+        keys.push_back("key" + std::to_string(i));
+    for (const auto& key : keys)
+        map.set(key, key);
+    map.set(keys[10], "changed");
+    EXPECT_EQ(1000u, map.size());
+    for (int i = 0; i < 1000; i++)
+        ASSERT_EQ(std::optional<std::string_view>(i == 10 ? "changed" : keys[i]), map.find(keys[i]));
+    EXPECT_FALSE(map.contains("key1000"));
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static void defineRemote(Application& app) {
+    app.addFlag("--verbose", "-v", "Be more verbose");
+    auto& remote = app.addCommand("remote").desc("Manage tracked repositories");
+    remote.addParameter("--config", "-c", "Configuration file", "path");
+    remote.addCommand("add").desc("Add a remote")
+        .addFlag("--fetch", "-f", "Fetch after adding")
+        .addArg("name", "identifier")
+        .addArg("url", "url")
+        .handler([](Actual*) { return 11; });
+    remote.addCommand("remove", "Remove a remote", [](Command& cmd) {
+        cmd.addArg("name", "identifier")
+            .handler([](Actual*) { return 12; });
+    });
+    auto& set = remote.addCommand("set").desc("Change remote settings");
+    set.addCommand("url").desc("Change URL")
+        .addArg("url", "url")
+        .handler([](Actual*) { return 13; });
+}
+
+TEST(NestedTest, DispatchWalksPath) {
+    Application app("test", 1, 1, 1);
+    defineRemote(app);
+    app.parse("test remote add -fv -c cfg origin https://example.com/repo.git");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_EQ("remote add", cmd->m_name);
+    EXPECT_TRUE(cmd->containsFlag("--fetch"));
+    EXPECT_TRUE(cmd->containsFlag("--verbose"));
+    EXPECT_EQ(cmd->getValue("--config"), std::optional<std::string>("cfg"));
+    EXPECT_EQ(2u, cmd->arguments.size());
+    EXPECT_EQ(11, app.execute());
+
+    app.parse("test remote remove origin");
+    EXPECT_EQ(12, app.execute());
+    app.parse("test remote set url https://example.com/other.git");
+    EXPECT_EQ(13, app.execute());
+}
+
+TEST(NestedTest, UnknownSubcommandProposesSiblings) {
+    Application app("test", 1, 1, 1);
+    defineRemote(app);
+    app.freeze();
+    app.parse("test remote ad origin");
+    auto cmd = app.currentCommand;
+    EXPECT_EQ(ErrorCode::UnknownCommand, cmd->errNumber);
+    EXPECT_EQ(std::vector<std::string>{"add"}, cmd->mostSimilar);
+
+    app.parse("test remote set url");
+    EXPECT_EQ(ErrorCode::TooFewArguments, app.currentCommand->errNumber);
+}
+
+TEST(NestedTest, HelpOfNestedCommand) {
+    Application app("test", 1, 1, 1);
+    defineRemote(app);
+    testing::internal::CaptureStdout();
+    app.parse("test help remote add");
+    app.execute();
+    auto out = testing::internal::GetCapturedStdout();
+    EXPECT_NE(std::string::npos, out.find("remote add"));
+    EXPECT_NE(std::string::npos, out.find("--fetch"));
+    EXPECT_NE(std::string::npos, out.find("--config"));
+
+    testing::internal::CaptureStdout();
+    app.parse("test help remote");
+    app.execute();
+    out = testing::internal::GetCapturedStdout();
+    EXPECT_NE(std::string::npos, out.find("remote remove"));
+}
+
+TEST(NestedTest, DuplicateTokenRejected) {
+    Application app("test", 1, 1, 1);
+    auto& remote = app.addCommand("remote");
+    remote.addCommand("add");
+    EXPECT_THROW(remote.addCommand("add"), std::runtime_error);
+    EXPECT_THROW(remote.addCommand("--add"), std::invalid_argument);
+}
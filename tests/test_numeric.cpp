@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+TEST(NumericTest, Integers) {
+    int64_t v = 0;
+    EXPECT_TRUE(parseInteger("0", v));
+    EXPECT_EQ(0, v);
+    EXPECT_TRUE(parseInteger("-42", v));
+    EXPECT_EQ(-42, v);
+    EXPECT_TRUE(parseInteger("1234567890123", v));
+    EXPECT_EQ(1234567890123, v);
+    EXPECT_TRUE(parseInteger("9223372036854775807", v));
+    EXPECT_EQ(std::numeric_limits<int64_t>::max(), v);
+    EXPECT_TRUE(parseInteger("-9223372036854775808", v));
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), v);
+    for (auto bad : {"", "-", "-0", "007", "+1", "12a", "1 ", "9223372036854775808", "12345678901234567890"})
+        EXPECT_FALSE(parseInteger(bad, v)) << bad;
+}
+
+TEST(NumericTest, Floats) {
+    double v = 0;
+    EXPECT_TRUE(parseFloat("1.5", false, v));
+    EXPECT_EQ(1.5, v);
+    EXPECT_TRUE(parseFloat("+2.", false, v));
+    EXPECT_EQ(2.0, v);
+    EXPECT_TRUE(parseFloat("-1.25e3", true, v));
+    EXPECT_EQ(-1250.0, v);
+    EXPECT_TRUE(parseFloat("7", true, v));
+    EXPECT_EQ(7.0, v);
+    EXPECT_FALSE(parseFloat("1e3", false, v));
+    for (auto bad : {"", ".5", "01.5", "1.5e", "1..2", "nan", "inf", "0x10"})
+        EXPECT_FALSE(parseFloat(bad, true, v)) << bad;
+}
+
+TEST(NumericTest, DigitPrefix) {
+    std::string digits(40, '7');
+    EXPECT_EQ(40u, digitPrefixLength(digits.data(), digits.size()));
+    digits[33] = '/';
+    EXPECT_EQ(33u, digitPrefixLength(digits.data(), digits.size()));
+    digits[5] = ':';
+    EXPECT_EQ(5u, digitPrefixLength(digits.data(), digits.size()));
+}
+
+TEST(NumericTest, VariadicArgumentsAsSpan) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("load")
+        .addArg("table", "identifier")
+        .addArgs("values", "integer", 1)
+        .handler([](Actual*) { return 0; });
+    app.addCommand("scale")
+        .addArgs("factors", "number", 1)
+        .handler([](Actual*) { return 0; });
+    std::vector<std::string> args = {"test", "load", "points"};
+    for (int i = -50000; i < 50000; i++)
+        args.push_back(std::to_string(i * 1000003LL));
+    app.parse(args);
+    auto load = app.getCommand("load");
+    ASSERT_EQ(0, load->errNumber) << *load->errorStr;
+    auto values = load->getIntegers();
+    ASSERT_EQ(100000u, values.size());
+    EXPECT_EQ(-50000 * 1000003LL, values[0]);
+    EXPECT_EQ(49999 * 1000003LL, values[99999]);
+    EXPECT_TRUE(load->getNumbers().empty());
+
+    app.parse("test load points 1 2x 3");
+    EXPECT_EQ(ErrorCode::IsNotExpectedTypeArg, load->errNumber);
+    EXPECT_TRUE(load->getIntegers().empty());
+
+    app.parse("test scale 1 2.5 -3e2");
+    auto scale = app.getCommand("scale");
+    ASSERT_EQ(0, scale->errNumber) << *scale->errorStr;
+    auto factors = scale->getNumbers();
+    EXPECT_EQ((std::vector<double>{1, 2.5, -300}), std::vector<double>(factors.begin(), factors.end()));
+}
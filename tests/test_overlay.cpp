@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+struct RegionValidator : Validator {
+    [[nodiscard]] std::string name() const override { return "region"; }
+    [[nodiscard]] bool validate(const std::string& value, std::string& found) const override {
+        found = "region";
+        return value == "eu" || value == "us";
+    }
+};
+
+static void defineSchema(Application& app) {
+    app.addDefParameter("--format", "-f", "Output format", "identifier", "text");
+    app.addCommand("deploy").desc("Deploy service")
+        .addArg("service", "identifier")
+        .addParameter("--region", "-r", "Target region", "region")
+        .addReqParameter("--owner", "", "Owning team", "identifier")
+        .handler([](Actual*) { return 0; });
+    app.addCommand("gc").desc("Collect garbage").handler([](Actual*) { return 0; });
+    app.addCommand("remote", "Manage remotes", [](Command& cmd) {
+        cmd.addCommand("add").desc("Add remote").addArg("name", "identifier").handler([](Actual*) { return 0; });
+        cmd.addCommand("remove").desc("Remove remote").addArg("name", "identifier").handler([](Actual*) { return 0; });
+    });
+}
+
+static std::string helpOf(const SchemaOverlay& overlay, const std::vector<std::string>& args) {
+    CommandScratch scratch;
+    auto& command = overlay.parse(args, scratch);
+    testing::internal::CaptureStdout();
+    command.execute();
+    return testing::internal::GetCapturedStdout();
+}
+
+TEST(OverlayTest, DeltasOverSharedBase) {
+    Application app("t", 1, 1, 1);
+    ValidatorManager::instance().register_validator(std::make_unique<RegionValidator>());
+    defineSchema(app);
+    SchemaOverlay plain(app), tenant(app);
+    tenant.hideCommand("gc")
+        .hideCommand("remote add")
+        .setDefault("deploy", "--owner", "ops")
+        .setDefault("", "--format", "json")
+        .addChoices("deploy", "--region", {"ap"})
+        .addChoices("deploy", "service", {"legacy-api"});
+
+    CommandScratch scratch;
+    auto& gc = tenant.parse({"t", "gc"}, scratch);
+    EXPECT_EQ(ErrorCode::UnknownCommand, gc.errNumber);
+    EXPECT_EQ(0, plain.parse({"t", "gc"}, scratch).errNumber);
+    EXPECT_EQ(ErrorCode::UnknownCommand, tenant.parse({"t", "remote", "add", "x"}, scratch).errNumber);
+    EXPECT_EQ(0, tenant.parse({"t", "remote", "remove", "x"}, scratch).errNumber);
+
+    auto& deploy = tenant.parse({"t", "deploy", "-r", "ap", "legacy-api"}, scratch);
+    EXPECT_EQ(0, deploy.errNumber);
+    EXPECT_EQ(&tenant, deploy.overlay);
+    EXPECT_EQ("ap", deploy.getValue("--region"));
+    EXPECT_EQ("ops", deploy.getValue("--owner"));
+    EXPECT_EQ("json", deploy.getValue("--format"));
+    auto& given = tenant.parse({"t", "deploy", "--owner", "web", "-f", "xml", "api"}, scratch);
+    EXPECT_EQ(0, given.errNumber);
+    EXPECT_EQ("web", given.getValue("--owner"));
+
+    // the same copy of command serves base schema without deltas
+    auto& base = plain.parse({"t", "deploy", "-r", "ap", "api"}, scratch);
+    EXPECT_EQ(ErrorCode::IsNotExpectedTypeParam, base.errNumber);
+    EXPECT_EQ(ErrorCode::RequiredParameterMissing, plain.parse({"t", "deploy", "api"}, scratch).errNumber);
+    EXPECT_EQ("text", plain.parse({"t", "deploy", "--owner", "o", "api"}, scratch).getValue("--format"));
+    app.parse(std::vector<std::string>{"t", "gc"});
+    EXPECT_EQ(0, app.execute());
+
+    auto list = helpOf(tenant, {"t", "help"});
+    EXPECT_EQ(std::string::npos, list.find("gc"));
+    EXPECT_NE(std::string::npos, list.find("deploy"));
+    EXPECT_NE(std::string::npos, helpOf(plain, {"t", "help"}).find("gc"));
+    EXPECT_NE(std::string::npos, helpOf(tenant, {"t", "help", "gc"}).find("is not a t command"));
+
+    EXPECT_THROW(tenant.hideCommand("missing"), std::invalid_argument);
+    EXPECT_THROW(tenant.setDefault("deploy", "--missing", "x"), std::invalid_argument);
+    EXPECT_THROW(tenant.setDefault("deploy", "--region", "mars"), std::invalid_argument);
+    EXPECT_THROW(tenant.addChoices("deploy", "--nothing", {"x"}), std::invalid_argument);
+    EXPECT_THROW(app.addCommand("late"), std::logic_error);
+}
+
+TEST(OverlayTest, HiddenCommandsNotProposed) {
+    Application app("t", 1, 1, 1);
+    ValidatorManager::instance().register_validator(std::make_unique<RegionValidator>());
+    app.abbreviations = 1;
+    defineSchema(app);
+    app.addCommand("gen").desc("Generate code").handler([](Actual*) { return 0; });
+    SchemaOverlay plain(app), tenant(app);
+    tenant.hideCommand("gc").hideCommand("remote add");
+    auto values = [](const std::vector<CompletionCandidate>& candidates) {
+        std::vector<std::string> result;
+        for (const auto& candidate : candidates)
+            result.push_back(candidate.value);
+        return result;
+    };
+
+    EXPECT_EQ((std::vector<std::string>{"gc", "gen"}), values(app.complete({"t", "g"}, 1, &plain)));
+    EXPECT_EQ((std::vector<std::string>{"gen"}), values(app.complete({"t", "g"}, 1, &tenant)));
+    EXPECT_EQ((std::vector<std::string>{"remove"}), values(app.complete({"t", "remote", ""}, 2, &tenant)));
+    EXPECT_TRUE(app.complete({"t", "gc", "-"}, 2, &tenant).empty());
+    CommandScratch scratch;
+    auto& complete = tenant.parse({"t", "__complete", "1", "t", "g"}, scratch);
+    testing::internal::CaptureStdout();
+    EXPECT_EQ(0, complete.execute());
+    auto printed = testing::internal::GetCapturedStdout();
+    EXPECT_NE(std::string::npos, printed.find("gen\t"));
+    EXPECT_EQ(std::string::npos, printed.find("gc\t"));
+
+    // abbreviation is ambiguous only among visible commands
+    auto& ambiguous = plain.parse({"t", "g"}, scratch);
+    EXPECT_EQ(ErrorCode::AmbiguousPrefix, ambiguous.errNumber);
+    EXPECT_EQ((std::vector<std::string>{"gc", "gen"}), ambiguous.mostSimilar);
+    auto& resolved = tenant.parse({"t", "g"}, scratch);
+    EXPECT_EQ(0, resolved.errNumber);
+    EXPECT_EQ("gen", resolved.m_name);
+    EXPECT_EQ(ErrorCode::UnknownCommand, tenant.parse({"t", "gc"}, scratch).errNumber);
+    auto& nested = tenant.parse({"t", "remote", "add", "x"}, scratch);
+    EXPECT_EQ(ErrorCode::UnknownCommand, nested.errNumber);
+    EXPECT_EQ(std::find(nested.mostSimilar.begin(), nested.mostSimilar.end(), "add"), nested.mostSimilar.end());
+}
+
+TEST(OverlayTest, ConcurrentTenants) {
+    Application app("t", 1, 1, 1);
+    ValidatorManager::instance().register_validator(std::make_unique<RegionValidator>());
+    defineSchema(app);
+    std::vector<std::unique_ptr<SchemaOverlay>> tenants;
+    auto owner = [](int i) { return std::string("team") + char('a' + i % 26) + char('a' + i / 26); };
+    for (int i = 0; i < 100; i++) {
+        tenants.push_back(std::make_unique<SchemaOverlay>(app));
+        tenants.back()->setDefault("deploy", "--owner", owner(i));
+        if (i % 2)
+            tenants.back()->hideCommand("gc");
+    }
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&, t]() {
+            CommandScratch scratch;
+            for (int k = 0; k < 2000; k++) {
+                int i = (k * 7 + t) % 100;
+                auto& deploy = tenants[i]->parse({"t", "deploy", "svc"}, scratch);
+                if (deploy.errNumber || deploy.getValue("--owner") != owner(i))
+                    failures++;
+                auto& gc = tenants[i]->parse({"t", "gc"}, scratch);
+                if ((gc.errNumber == ErrorCode::UnknownCommand) != (i % 2 == 1))
+                    failures++;
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(0, failures.load());
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+TEST(PrefixIndexTest, FindRanges) {
+    PrefixIndex index({"commit", "clone", "clean", "config", "cherry", "cherry-pick", "add"});
+    EXPECT_EQ(7u, index.size());
+    auto m = index.find("c");
+    EXPECT_EQ(6u, m.count);
+    EXPECT_FALSE(m.exact);
+    m = index.find("cl");
+    EXPECT_EQ(2u, m.count);
+    EXPECT_EQ("clean", index.key(m.first));
+    m = index.find("cherry");
+    EXPECT_EQ(2u, m.count);
+    EXPECT_TRUE(m.exact);
+    EXPECT_EQ(0u, index.find("cx").count);
+    EXPECT_EQ(0u, index.find("commits").count);
+    EXPECT_EQ(1u, index.find("comm").count);
+    EXPECT_EQ(7u, index.find("").count);
+
+    std::vector<std::string> candidates;
+    EXPECT_EQ("cherry", *index.resolve("cherry", candidates));
+    EXPECT_EQ("config", *index.resolve("conf", candidates));
+    EXPECT_EQ(nullptr, index.resolve("co", candidates));
+    EXPECT_EQ((std::vector<std::string>{"commit", "config"}), candidates);
+}
+
+TEST(PrefixIndexTest, AbbreviatedCommandsAndOptions) {
+    Application app("test", 1, 1, 1);
+    app.abbreviations = 1;
+    app.addFlag("--verbose", "-v", "Be more verbose");
+    app.addCommand("clone").desc("Clone a repository")
+        .addFlag("--version", "", "Print version")
+        .addArg("repository", "url")
+        .handler([](Actual*) { return 3; });
+    app.addCommand("clean").desc("Remove untracked files");
+    app.addCommand("commit").desc("Record changes");
+    app.freeze();
+
+    app.parse("test clo --verb https://example.com/repo.git");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_EQ("clone", cmd->m_name);
+    EXPECT_TRUE(cmd->containsFlag("--verbose"));
+    EXPECT_EQ(3, app.execute());
+
+    app.parse("test clone --ver https://example.com/repo.git");
+    EXPECT_EQ(ErrorCode::AmbiguousPrefix, app.currentCommand->errNumber);
+    EXPECT_EQ((std::vector<std::string>{"--verbose", "--version"}), app.currentCommand->mostSimilar);
+
+    app.parse("test cl");
+    EXPECT_EQ(ErrorCode::AmbiguousPrefix, app.currentCommand->errNumber);
+    EXPECT_EQ((std::vector<std::string>{"clean", "clone"}), app.currentCommand->mostSimilar);
+
+    app.parse("test xyz");
+    EXPECT_EQ(ErrorCode::UnknownCommand, app.currentCommand->errNumber);
+}
+
+TEST(PrefixIndexTest, DisabledByDefault) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("clone").desc("Clone a repository");
+    app.freeze();
+    app.parse("test clo");
+    EXPECT_EQ(ErrorCode::UnknownCommand, app.currentCommand->errNumber);
+}
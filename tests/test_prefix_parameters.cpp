@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static void defineCompiler(Application& app) {
+    auto cmd = app.mainCommand;
+    cmd->addArgs("files", "path", 0);
+    cmd->addFlag("-print-sysroot", "", "Display the target libraries directory.");
+    cmd->addParameter("-o", "", "Place the output into <file>.", "path");
+    cmd->addPrefixParameter("-I", "Add include directory", "path");
+    cmd->addPrefixParameter("-D", "Define macro", "string");
+    cmd->addPrefixParameter("-O", "Optimization level", "string");
+    cmd->addPrefixParameter("-W", "Warning", "string");
+    cmd->addPrefixParameter("-Wl,", "Linker options", "string");
+    cmd->addPrefixParameter("-std=", "Language standard", "string");
+    cmd->addPrefixParameter("-p", "Prefix colliding with full name", "string");
+}
+
+TEST(PrefixParameterTest, JoinedValues) {
+    Application app("test", 0, 0, 1);
+    defineCompiler(app);
+    app.freeze();
+    app.parse("test -I/usr/include -O2 -DFOO=1 -std=c++17 -Wl,-rpath,/opt -Wno-unused -o out main.c");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber) << *cmd->errorStr;
+    EXPECT_EQ(cmd->getValue("-I"), std::optional<std::string>("/usr/include"));
+    EXPECT_EQ(cmd->getValue("-O"), std::optional<std::string>("2"));
+    EXPECT_EQ(cmd->getValue("-D"), std::optional<std::string>("FOO=1"));
+    EXPECT_EQ(cmd->getValue("-std="), std::optional<std::string>("c++17"));
+    EXPECT_EQ(cmd->getValue("-Wl,"), std::optional<std::string>("-rpath,/opt"));
+    EXPECT_EQ(cmd->getValue("-W"), std::optional<std::string>("no-unused"));
+    EXPECT_EQ(cmd->getValue("-o"), std::optional<std::string>("out"));
+    EXPECT_EQ(1u, cmd->arguments.size());
+}
+
+TEST(PrefixParameterTest, FullNameWinsOverPrefix) {
+    Application app("test", 0, 0, 1);
+    defineCompiler(app);
+    app.parse("test -print-sysroot -pthread");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_TRUE(cmd->containsFlag("-print-sysroot"));
+    EXPECT_EQ(cmd->getValue("-p"), std::optional<std::string>("thread"));
+}
+
+TEST(PrefixParameterTest, PrefixAloneIsNotMatched) {
+    Application app("test", 0, 0, 1);
+    defineCompiler(app);
+    app.parse("test -I");
+    EXPECT_NE(0, app.currentCommand->errNumber);
+    EXPECT_THROW(app.mainCommand->addPrefixParameter("-I", "again", "path"), std::invalid_argument);
+    EXPECT_THROW(app.mainCommand->addPrefixParameter("I", "no dash", "path"), std::invalid_argument);
+}
+
+TEST(PrefixParameterTest, SeparatedValue) {
+    Application app("test", 0, 0, 1);
+    auto cmd = app.mainCommand;
+    cmd->addArgs("files", "path", 0);
+    cmd->addPrefixParameter("-I", "Add include directory", "path", true, true);
+    cmd->addPrefixParameter("-B", "Add search path", "path", false, true);
+    cmd->addPrefixParameter("-O", "Optimization level", "string");
+    app.freeze();
+    app.parse("test -I dir -I/usr/include -B /opt/bin a.c");
+    ASSERT_EQ(0, app.currentCommand->errNumber) << *app.currentCommand->errorStr;
+    EXPECT_EQ(cmd->getValue("-B"), std::optional<std::string>("/opt/bin"));
+    auto includes = cmd->getValues("-I");
+    ASSERT_EQ(2u, includes.size());
+    EXPECT_EQ("dir", includes[0]);
+    EXPECT_EQ("/usr/include", includes[1]);
+    ASSERT_EQ(1u, cmd->arguments.size());
+    EXPECT_EQ("a.c", cmd->arguments[0].value);
+    app.parse("test a.c -B");
+    EXPECT_EQ(ErrorCode::UnexpectedCommandLineEnd, app.currentCommand->errNumber);
+    app.parse("test -B/opt -B /usr a.c");
+    EXPECT_EQ(ErrorCode::OptionUsedTwice, app.currentCommand->errNumber);
+    app.parse("test -O 2");
+    EXPECT_NE(0, app.currentCommand->errNumber);
+}
+
+TEST(PrefixParameterTest, PrefixAndOptionCantShareName) {
+    Application app("test", 0, 0, 1);
+    defineCompiler(app);
+    EXPECT_THROW(app.mainCommand->addParameter("-I", "", "Include directory", "path"), std::invalid_argument);
+    EXPECT_THROW(app.mainCommand->addFlag("-D", "", "Define"), std::invalid_argument);
+    EXPECT_THROW(app.mainCommand->addPrefixParameter("-o", "Output", "path"), std::invalid_argument);
+    app.mainCommand->addOptions({flag("-W", "", "Warnings")});
+    EXPECT_THROW(app.freeze(), std::invalid_argument);
+}
+
+TEST(PrefixParameterTest, LongestMatch) {
+    PrefixIndex index({"-W", "-Wl,", "-Wa,", "-std="});
+    EXPECT_EQ("-Wl,", *index.longestMatch("-Wl,-rpath"));
+    EXPECT_EQ("-W", *index.longestMatch("-Wall"));
+    EXPECT_EQ("-W", *index.longestMatch("-Wl"));
+    EXPECT_EQ("-std=", *index.longestMatch("-std=c++17"));
+    EXPECT_EQ(nullptr, index.longestMatch("-st"));
+    EXPECT_EQ(nullptr, index.longestMatch("-O2"));
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static std::string edit(LineEditor& editor, const std::string& keys) {
+    std::istringstream in(keys);
+    std::ostringstream out;
+    LineEditor session(in, out);
+    session.forceEditing(true);
+    for (const auto& entry : editor.history())
+        session.addHistory(entry);
+    std::string line;
+    EXPECT_TRUE(session.readLine("> ", line));
+    editor.addHistory(line);
+    return line;
+}
+
+TEST(ReplTest, LineEditing) {
+    std::istringstream none;
+    LineEditor editor(none, std::cout);
+    EXPECT_EQ("acb", edit(editor, "ab\x1b[Dc\r"));
+    EXPECT_EQ("cb", edit(editor, "\x1b[A\x01\x1b[3~\r"));
+    EXPECT_EQ("clone y", edit(editor, "clone x\x7fy\r"));
+    EXPECT_EQ("go", edit(editor, "one two\x17\x15go\r"));
+    EXPECT_EQ("clone y", edit(editor, "\x1b[A\x1b[A\x1b[A\x1b[B\r"));
+    EXPECT_EQ("zaż", edit(editor, "aż\x01z\r"));
+    EXPECT_EQ(6u, editor.history().size());
+}
+
+TEST(ReplTest, HistoryIsBounded) {
+    std::istringstream none;
+    LineEditor editor(none, std::cout, 3);
+    for (auto line : {"a", "b", "b", "", "c", "d"})
+        editor.addHistory(line);
+    EXPECT_EQ((std::deque<std::string>{"b", "c", "d"}), editor.history());
+}
+
+TEST(ReplTest, LoopDoesNotLeakParameters) {
+    std::vector<std::string> seen;
+    Application app("test", 1, 1, 1);
+    app.addCommand("show")
+        .addParameter("--name", "-n", "Name", "string")
+        .handler([&seen](Actual* actual) {
+            seen.push_back(actual->getValue("--name").value_or("-"));
+            return 0;
+        });
+    std::istringstream in("show -n first\n\nshow\r\nshow --name 'x y'\nshw\n");
+    LineEditor editor(in, std::cout);
+    EXPECT_EQ(ErrorCode::UnknownCommand, app.repl(editor));
+    EXPECT_EQ((std::vector<std::string>{"first", "-", "x y"}), seen);
+    EXPECT_EQ(4u, editor.history().size());
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static std::string writeFile(const std::string& name, const std::string& content) {
+    auto path = testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+
+TEST(ResponseFileTest, GccQuoting) {
+    std::vector<std::string_view> tokens;
+    std::string scratch;
+    std::string text = "  -O2\t-I'/usr/my include' \"a \\\"b\\\"\"\n\\@x ''  c\\ d\n";
+    splitResponseFile(text, tokens, scratch);
+    std::vector<std::string> got(tokens.begin(), tokens.end());
+    EXPECT_EQ(got, (std::vector<std::string>{"-O2", "-I/usr/my include", "a \"b\"", "@x", "", "c d"}));
+    // plain token is view into text
+    EXPECT_EQ(text.data() + 2, tokens[0].data());
+}
+
+TEST(ResponseFileTest, ExpandedNestedAndLiteral) {
+    auto inner = writeFile("clicmd-inner.rsp", "-o out\n");
+    auto outer = writeFile("clicmd-outer.rsp", "-DX main.c @" + inner + " 'second file.c'");
+    Application app("test", 0, 0, 1);
+    app.responseFiles = 1;
+    auto cmd = app.mainCommand;
+    cmd->addArgs("files", "string", 0);
+    cmd->addParameter("-o", "", "Output", "path");
+    cmd->addPrefixParameter("-D", "Define macro", "string");
+    cmd->handler([](Actual*) { return 0; });
+    app.parse({"test", "@" + outer, "@missing.rsp"});
+    ASSERT_EQ(0, cmd->errNumber) << *cmd->errorStr;
+    EXPECT_EQ(cmd->getValue("-D"), std::optional<std::string>("X"));
+    EXPECT_EQ(cmd->getValue("-o"), std::optional<std::string>("out"));
+    ASSERT_EQ(3u, cmd->arguments.size());
+    EXPECT_EQ("second file.c", cmd->arguments[1].value);
+    EXPECT_EQ("@missing.rsp", cmd->arguments[2].value);
+
+    app.responseFiles = 0;
+    app.parse({"test", "@" + outer});
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_EQ("@" + outer, cmd->arguments[0].value);
+}
+
+TEST(ResponseFileTest, Cycle) {
+    auto a = testing::TempDir() + "clicmd-a.rsp";
+    auto b = writeFile("clicmd-b.rsp", "x @" + a);
+    writeFile("clicmd-a.rsp", "y @" + b);
+    Application app("test", 0, 0, 1);
+    app.responseFiles = 1;
+    app.mainCommand->addArgs("files", "string", 0);
+    app.parse({"test", "@" + a});
+    EXPECT_EQ(ErrorCode::ResponseFileCycle, app.currentCommand->errNumber);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using json = nlohmann::json;
+
+TEST(SchemaJsonTest, CommandsAndGlobals) {
+    cli::Application app("test", 1, 1, 1);
+    app.addFlag("--verbose", "-v", "be more verbose");
+    app.addCommand("build")
+        .desc("Build targets")
+        .addParameter("--output", "-o", "Output file path", "path")
+        .addArgs("targets", "identifier", 0, 2);
+
+    json expected = R"({
+        "app": "test",
+        "combineOpts": 1,
+        "global": {
+            "arguments": [],
+            "flags": [ { "name": "--verbose", "desc": "be more verbose", "shorthand": "-v" } ],
+            "parameters": []
+        },
+        "commands": [
+            {
+                "name": "build",
+                "desc": "Build targets",
+                "formal": {
+                    "arguments": [],
+                    "flags": [],
+                    "parameters": [
+                        {
+                            "defValue": "",
+                            "desc": "Output file path",
+                            "expectType": "path",
+                            "name": "--output",
+                            "parameterMode": "Optional",
+                            "shorthand": "-o"
+                        }
+                    ],
+                    "varargs": { "name": "targets", "expectType": "identifier", "min-n": 0, "max-n": 2 }
+                }
+            }
+        ]
+    })"_json;
+    EXPECT_EQ(expected, app.schemaAsJson());
+}
+
+TEST(SchemaJsonTest, FormalShapeIsShared) {
+    cli::Application app("test", 1, 1, 1);
+    app.addCommand("clone")
+        .addArg("repository", "url")
+        .addFlag("--bare", "", "");
+    json schema = app.schemaAsJson();
+    EXPECT_EQ(app.getCommand("clone")->formalAsJson(), schema["commands"][0]["formal"]);
+}
+
+TEST(SchemaJsonTest, KeepsAllFeatures) {
+    cli::Application app("test", 2, 1, 1);
+    app.addFlag("--old", "", "Deprecated");
+    app.addCategory("Main")->addCommand("build")
+        .addListParameter("--define", "-D", "Macro", "string")
+        .addMapParameter("--env", "", "Environment", "string")
+        .addPrefixParameter("-I", "Include directory", "path", true, true)
+        .hideOption("--old");
+    app.addCommand("remote").addCommand("add").desc("Add a remote");
+    app.addCommand("run").addArgs("items", "string", 0).addArgsFrom();
+    app.addHelpCategory("Common").ref("build");
+
+    json schema = app.schemaAsJson();
+    const json& build = schema["commands"][0];
+    EXPECT_EQ(json::array({"--old"}), build["hidden"]);
+    const json& parameters = build["formal"]["parameters"];
+    EXPECT_EQ(true, parameters[0]["repeatable"]);
+    EXPECT_EQ(true, parameters[1]["keyValue"]);
+    const json& prefix = build["formal"]["prefixParameters"][0];
+    EXPECT_EQ("-I", prefix["name"]);
+    EXPECT_EQ(true, prefix["repeatable"]);
+    EXPECT_EQ(true, prefix["separated"]);
+    const json& remote = schema["commands"][1];
+    EXPECT_EQ("add", remote["commands"][0]["name"]);
+    EXPECT_EQ("Add a remote", remote["commands"][0]["desc"]);
+    EXPECT_EQ(true, schema["commands"][2]["argsFrom"]);
+    EXPECT_EQ(R"([{"desc": "Main", "commands": ["build"]}])"_json, schema["categories"]);
+    EXPECT_EQ(R"([{"desc": "Common", "commands": ["build"]}])"_json, schema["helpCategories"]);
+}
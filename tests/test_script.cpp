@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static std::string writeFile(const std::string& name, const std::string& content) {
+    auto path = testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary) << content;
+    return path;
+}
+
+TEST(ScriptTest, LinesExecutedInOrder) {
+    std::vector<std::string> seen;
+    Application app("test", 1, 1, 1);
+    app.addCommand("push")
+        .addArg("item", "string")
+        .addFlag("--twice", "-t", "push item twice")
+        .handler([&seen](Actual* actual) {
+            int n = actual->containsFlag("--twice") ? 2 : 1;
+            for (int i = 0; i < n; i++)
+                seen.emplace_back(actual->arguments[0].value);
+            return 0;
+        });
+    std::string script = "# provisioning\n\n";
+    for (int i = 0; i < 300; i++)
+        script += "push item" + std::to_string(i) + "\r\n";
+    script += "  push -t 'last item'";
+    EXPECT_EQ(0, app.runScript(writeFile("clicmd-script.txt", script)));
+    ASSERT_EQ(302u, seen.size());
+    EXPECT_EQ("item0", seen[0]);
+    EXPECT_EQ("item299", seen[299]);
+    EXPECT_EQ("last item", seen[301]);
+    EXPECT_EQ(303u, app.scriptLine);
+}
+
+TEST(ScriptTest, StopsAtFirstFailure) {
+    int executed = 0;
+    Application app("test", 1, 1, 1);
+    app.addCommand("step")
+        .addArg("n", "integer")
+        .handler([&executed](Actual* actual) {
+            executed++;
+            return actual->arguments[0].value == "3" ? 7 : 0;
+        });
+    auto path = writeFile("clicmd-failing.txt", "step 1\nstep 2\nstep 3\nstep 4\n");
+    EXPECT_EQ(7, app.runScript(path));
+    EXPECT_EQ(3, executed);
+    EXPECT_EQ(3u, app.scriptLine);
+
+    path = writeFile("clicmd-bad.txt", "step 1\nstep x\nstep 2\n");
+    EXPECT_EQ(ErrorCode::IsNotExpectedTypeArg, app.runScript(path));
+    EXPECT_EQ(4, executed);
+    EXPECT_EQ(2u, app.scriptLine);
+    EXPECT_THROW(app.runScript(testing::TempDir() + "clicmd-no-such-script.txt"), std::runtime_error);
+}
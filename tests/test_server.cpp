@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+struct Output {
+    int code;
+    std::string out;
+    std::string err;
+};
+
+static std::string drain(int fd) {
+    std::string text;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+        text.append(buffer, static_cast<size_t>(n));
+    close(fd);
+    return text;
+}
+
+// client output goes through pipes, read by helper threads so the server never blocks on them
+static Output forward(const std::string& socketPath, const std::vector<std::string>& args) {
+    int out[2], err[2];
+    EXPECT_EQ(0, pipe(out));
+    EXPECT_EQ(0, pipe(err));
+    std::string outText, errText;
+    std::thread outReader([&]() { outText = drain(out[0]); });
+    std::thread errReader([&]() { errText = drain(err[0]); });
+    auto finish = [&]() {
+        close(out[1]);
+        close(err[1]);
+        outReader.join();
+        errReader.join();
+    };
+    int code;
+    try {
+        code = forwardCommand(socketPath, args, out[1], err[1]);
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+    return {code, outText, errText};
+}
+
+// server binds its socket asynchronously, first client retries until it listens
+static void waitForServer(const std::string& socketPath) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    for (;;) {
+        try {
+            forward(socketPath, {"test", "ping"});
+            return;
+        } catch (const std::runtime_error&) {
+            if (std::chrono::steady_clock::now() > deadline)
+                throw;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+TEST(ServerTest, ForwardsCommands) {
+    auto socketPath = (std::filesystem::temp_directory_path() / ("clicmd-server-" + std::to_string(getpid()) + ".sock")).string();
+    auto dir = std::filesystem::temp_directory_path() / ("clicmd-server-" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommand("ping").handler([](Actual*) { return 0; });
+        app.addCommand("echo")
+            .addArgs("words", "string", 0)
+            .addParameter("--code", "-c", "Exit code", "integer")
+            .handler([](Actual* actual) {
+                for (const auto& word : actual->arguments)
+                    std::cout << word.value << ' ';
+                std::cout << std::endl;
+                std::cerr << "done" << std::endl;
+                auto code = actual->getValue("--code");
+                return code ? std::stoi(*code) : 0;
+            });
+        app.addCommand("each")
+            .addArgs("items", "string", 0)
+            .itemHandler([](const Actual*, const std::string& item, std::ostream& out) {
+                out << item << '\n';
+                return item == "bad" ? 2 : 0;
+            });
+        app.addCommand("where").handler([](Actual*) {
+            std::cout << currentRequest()->getenv("CLICMD_TEST_USER") << ' '
+                      << std::filesystem::current_path().string() << std::endl;
+            return 0;
+        });
+        std::thread server([&app, &socketPath]() { app.serve(socketPath, 4); });
+        waitForServer(socketPath);
+        EXPECT_EQ(std::filesystem::perms::owner_read | std::filesystem::perms::owner_write
+                | std::filesystem::perms::owner_exec, std::filesystem::status(socketPath).permissions());
+
+        auto result = forward(socketPath, {"test", "echo", "-c", "3", "a", "b"});
+        EXPECT_EQ(3, result.code);
+        EXPECT_EQ("a b \n", result.out);
+        EXPECT_EQ("done\n", result.err);
+        result = forward(socketPath, {"test", "ech"});
+        EXPECT_NE(0, result.code);
+        EXPECT_NE(std::string::npos, result.out.find("'ech' is not a test command"));
+
+        setenv("CLICMD_TEST_USER", "alice", 1);
+        auto cwd = std::filesystem::current_path();
+        std::filesystem::current_path(dir);
+        result = forward(socketPath, {"test", "where"});
+        std::filesystem::current_path(cwd);
+        unsetenv("CLICMD_TEST_USER");
+#ifdef __linux__
+        EXPECT_EQ(0, result.code);
+        EXPECT_EQ("alice " + std::filesystem::canonical(dir).string() + "\n", result.out);
+        EXPECT_EQ(cwd, std::filesystem::current_path()); // server process didn't move
+#else
+        EXPECT_NE(0, result.code); // working directory of request can't be applied
+#endif
+
+        // concurrent requests keep their own arguments and output
+        std::vector<std::thread> clients;
+        std::vector<Output> results(32);
+        for (size_t i = 0; i < results.size(); i++)
+            clients.emplace_back([&, i]() {
+                auto word = "w" + std::to_string(i);
+                if (i % 2)
+                    results[i] = forward(socketPath, {"test", "each", word, word + "x"});
+                else
+                    results[i] = forward(socketPath, {"test", "echo", "--code", std::to_string(i), word});
+            });
+        for (auto& client : clients)
+            client.join();
+        for (size_t i = 0; i < results.size(); i++) {
+            auto word = "w" + std::to_string(i);
+            EXPECT_EQ(i % 2 ? 0 : static_cast<int>(i), results[i].code);
+            EXPECT_EQ(i % 2 ? word + "\n" + word + "x\n" : word + " \n", results[i].out);
+        }
+        // item handler runs on the parsed copy of command, not on the shared one
+        result = forward(socketPath, {"test", "each", "ok", "bad"});
+        EXPECT_EQ(2, result.code);
+        EXPECT_EQ("ok\nbad\n", result.out);
+        EXPECT_EQ(nullptr, app.currentCommand);
+
+        app.stopServing();
+        server.join();
+        EXPECT_FALSE(std::filesystem::exists(socketPath));
+        EXPECT_THROW(forward(socketPath, {"test", "ping"}), std::runtime_error);
+
+        // regular file in place of socket is not removed
+        std::ofstream(socketPath) << "data";
+        EXPECT_THROW(app.serve(socketPath, 1), std::runtime_error);
+        EXPECT_EQ(4u, std::filesystem::file_size(socketPath));
+        std::filesystem::remove(socketPath);
+    }
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static void defineSchema(Application& app) {
+    app.addFlag("--verbose", "-v", "Be more verbose");
+    app.addDefParameter("--color", "", "Colorize output", "identifier", "auto");
+    app.addCommand("init").desc("Create repository");
+    auto* category = app.addCategory("work on the current change");
+    category->addCommand("add").desc("Add file contents")
+        .addFlag("--force", "-f", "Allow adding ignored files")
+        .addArgs("paths", "path", 1);
+    category->addCommand("clone").desc("Clone a repository")
+        .addReqParameter("--depth", "", "Shallow clone depth", "integer")
+        .addArg("repository", "url")
+        .hideOption("--color");
+}
+
+static std::vector<char> makeImage() {
+    Application app("test", 2, 1, 1);
+    defineSchema(app);
+    return app.snapshotImage();
+}
+
+TEST(SnapshotTest, FreezeRejectsSchemaChanges) {
+    Application app("test", 2, 1, 1);
+    defineSchema(app);
+    app.freeze();
+    app.freeze();
+    EXPECT_TRUE(app.isFrozen());
+    EXPECT_THROW(app.addCommand("commit"), std::logic_error);
+    EXPECT_THROW(app.getCommand("init")->addFlag("--bare", "", "bare"), std::logic_error);
+    EXPECT_THROW(app.addCategory("other"), std::logic_error);
+    app.getCommand("init")->handler([](Actual*) { return 3; });
+    app.parse("test init");
+    EXPECT_EQ(3, app.execute());
+}
+
+TEST(SnapshotTest, LoadedCommandsParse) {
+    auto image = Snapshot::fromBytes(makeImage());
+    EXPECT_EQ("test", image->appName());
+    EXPECT_EQ(3u, image->commandCount());
+    EXPECT_EQ(std::optional<size_t>(1), image->findCommand("clone"));
+    EXPECT_EQ(std::nullopt, image->findCommand("commit"));
+
+    Application app("test", 2, 1, 1);
+    app.loadSnapshot(image);
+    EXPECT_TRUE(app.isFrozen());
+    app.bindHandler("add", [](Actual*) { return 5; });
+    app.parse("test add -fv a.txt b.txt");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_TRUE(cmd->containsFlag("-f"));
+    EXPECT_TRUE(cmd->containsFlag("--verbose"));
+    EXPECT_EQ(cmd->getValue("--color"), std::optional<std::string>("auto"));
+    EXPECT_EQ(2u, cmd->arguments.size());
+    EXPECT_EQ(5, app.execute());
+
+    app.parse("test clone https://example.com/repo.git");
+    EXPECT_EQ(ErrorCode::RequiredParameterMissing, app.currentCommand->errNumber);
+    app.parse("test clone --depth 1 --color never https://example.com/repo.git");
+    EXPECT_EQ(ErrorCode::UnknownLongOption, app.currentCommand->errNumber);
+
+    app.parse("test clne");
+    EXPECT_EQ(ErrorCode::UnknownCommand, app.currentCommand->errNumber);
+    EXPECT_EQ(std::vector<std::string>{"clone"}, app.currentCommand->mostSimilar);
+    EXPECT_THROW(app.addCommand("commit"), std::logic_error);
+}
+
+struct SnapshotProbe : Application {
+    using Application::Application;
+    using Application::commandIndexBuilt;
+    using Application::builtCommandCount;
+};
+
+TEST(SnapshotTest, LoadDoesNotIndexCommandNames) {
+    auto image = Snapshot::fromBytes(makeImage());
+    SnapshotProbe app("test", 2, 1, 1);
+    app.loadSnapshot(image);
+    EXPECT_FALSE(app.commandIndexBuilt());
+    app.parse("test add a.txt");
+    EXPECT_FALSE(app.commandIndexBuilt());
+    app.abbreviations = 1;
+    app.parse("test clo --depth 1 https://example.com/repo.git");
+    EXPECT_TRUE(app.commandIndexBuilt());
+    EXPECT_EQ(ErrorCode::MissingHandler, app.currentCommand->errNumber);
+}
+
+TEST(SnapshotTest, BindingHandlerDoesNotBuildCommand) {
+    auto image = Snapshot::fromBytes(makeImage());
+    SnapshotProbe app("test", 2, 1, 1);
+    app.loadSnapshot(image);
+    app.bindHandler("init", [](Actual*) { return 3; }).bindHandler("clone", [](Actual*) { return 4; });
+    EXPECT_THROW(app.bindHandler("commit", [](Actual*) { return 0; }), std::runtime_error);
+    EXPECT_EQ(0u, app.builtCommandCount());
+    app.parse("test init");
+    EXPECT_EQ(1u, app.builtCommandCount());
+    EXPECT_EQ(3, app.execute());
+    app.bindHandler("init", [](Actual*) { return 6; });
+    app.parse("test init");
+    EXPECT_EQ(6, app.execute());
+    app.parse("test clone --depth 1 https://example.com/repo.git");
+    EXPECT_EQ(4, app.execute());
+}
+
+TEST(SnapshotTest, FormalMatchesRegisteredSchema) {
+    json registered, loaded;
+    {
+        Application app("test", 2, 1, 1);
+        defineSchema(app);
+        registered = app.getCommand("clone")->formalAsJson();
+    }
+    auto image = Snapshot::fromBytes(makeImage());
+    {
+        Application app("test", 2, 1, 1);
+        app.loadSnapshot(image);
+        loaded = app.getCommand("clone")->formalAsJson();
+    }
+    EXPECT_EQ(registered, loaded);
+}
+
+TEST(SnapshotTest, HelpListsCategories) {
+    std::string registered, loaded;
+    {
+        Application app("test", 2, 1, 1);
+        defineSchema(app);
+        testing::internal::CaptureStdout();
+        app.parse("test help");
+        app.execute();
+        registered = testing::internal::GetCapturedStdout();
+    }
+    auto image = Snapshot::fromBytes(makeImage());
+    {
+        Application app("test", 2, 1, 1);
+        app.loadSnapshot(image);
+        testing::internal::CaptureStdout();
+        app.parse("test help");
+        app.execute();
+        loaded = testing::internal::GetCapturedStdout();
+    }
+    EXPECT_EQ(registered, loaded);
+    EXPECT_NE(std::string::npos, loaded.find("work on the current change"));
+}
+
+TEST(SnapshotTest, FileRoundTrip) {
+    std::string path = testing::TempDir() + "clicmd-snapshot.bin";
+    {
+        Application app("test", 2, 1, 1);
+        defineSchema(app);
+        app.saveSnapshot(path);
+    }
+    {
+        Application app("test", 2, 1, 1);
+        app.loadSnapshot(Snapshot::open(path));
+        app.parse("test init");
+        EXPECT_EQ(ErrorCode::MissingHandler, app.currentCommand->errNumber);
+        EXPECT_THROW(app.snapshotImage(), std::logic_error);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(SnapshotTest, RejectsBadImage) {
+    auto bytes = makeImage();
+    auto truncated = bytes;
+    truncated.resize(bytes.size() - 4);
+    EXPECT_THROW(Snapshot::fromBytes(truncated), std::runtime_error);
+    auto badMagic = bytes;
+    badMagic[0] = 'X';
+    EXPECT_THROW(Snapshot::fromBytes(badMagic), std::runtime_error);
+    EXPECT_THROW(Snapshot::fromBytes({}), std::runtime_error);
+    EXPECT_THROW(Snapshot::open("/nonexistent/clicmd-snapshot.bin"), std::runtime_error);
+
+    Application app("test", 1, 1, 1);
+    EXPECT_THROW(app.loadSnapshot(Snapshot::fromBytes(bytes)), std::invalid_argument);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static int build_(const Actual*) { return 7; }
+
+static_assert(isCommandName("clone"));
+static_assert(isCommandName("init-repo"));
+static_assert(!isCommandName("help"));
+static_assert(!isCommandName("bad-"));
+static_assert(isOptionName("--output", true));
+static_assert(!isOptionName("--o", true));
+static_assert(isOptionName("-o", true));
+static_assert(!isOptionName("-std", true));
+static_assert(isOptionName("-std", false));
+
+constexpr StaticOption buildOptions[] = {
+    flag("--release", "-r", "Enable release mode"),
+    parameter("--output", "-o", "Set output file path", "path"),
+    defParameter("--jobs", "-j", "Number of jobs", "integer", "1"),
+};
+
+constexpr StaticArgument buildArguments[] = {
+    args("targets", "identifier", 0),
+};
+
+constexpr StaticCommand commands[] = {
+    command("build", "Build targets", buildOptions, buildArguments, build_),
+    command("clean", "Remove build files"),
+    command("archive", "Pack sources"),
+};
+
+constexpr StaticSchema schema(commands, true);
+
+static_assert(schema.size() == 3);
+static_assert(schema.begin()->name == "archive");
+static_assert(schema.find("build")->handler == build_);
+static_assert(schema.find("clean")->handler == nullptr);
+static_assert(schema.find("test") == nullptr);
+
+TEST(StaticSchemaTest, RegisterAndParse) {
+    Application app("test", 1, 1, 1);
+    app.addCommands(schema);
+    app.parse("test build -r --output out.bin core util");
+    auto cmd = app.currentCommand;
+    ASSERT_EQ(0, cmd->errNumber);
+    EXPECT_TRUE(cmd->containsFlag("--release"));
+    EXPECT_EQ(cmd->getValue("--output"), std::optional<std::string>("out.bin"));
+    EXPECT_EQ(cmd->getValue("--jobs"), std::optional<std::string>("1"));
+    EXPECT_EQ(2u, cmd->arguments.size());
+    EXPECT_EQ(7, app.execute());
+}
+
+TEST(StaticSchemaTest, FormalMatchesRuntimeDefinition) {
+    json fromSchema, fromCode;
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommands(schema);
+        fromSchema = app.getCommand("build")->formalAsJson();
+    }
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommand("build")
+            .addFlag("--release", "-r", "Enable release mode")
+            .addParameter("--output", "-o", "Set output file path", "path")
+            .addDefParameter("--jobs", "-j", "Number of jobs", "integer", "1")
+            .addArgs("targets", "identifier", 0);
+        fromCode = app.getCommand("build")->formalAsJson();
+    }
+    EXPECT_EQ(fromCode, fromSchema);
+}
+
+TEST(StaticSchemaTest, RuntimeConflicts) {
+    {
+        Application app("test", 0, 0, 1);
+        EXPECT_THROW(app.addCommands(schema), std::logic_error); // checked for combineOpts = 1
+    }
+    {
+        Application app("test", 1, 1, 1);
+        app.addCommand("clean");
+        EXPECT_THROW(app.addCommands(schema), std::runtime_error);
+    }
+}
+
+TEST(StaticSchemaTest, CommandsAreReadOnDispatch) {
+    Application app("test", 1, 1, 1);
+    app.addFlag("--recursive", "-r", "Recurse into directories");
+    app.addCommands(schema); // "-r" of build is not read yet
+    app.parse("test clean -r");
+    EXPECT_EQ(ErrorCode::MissingHandler, app.currentCommand->errNumber); // parsed fine
+    EXPECT_THROW(app.getCommand("build"), std::invalid_argument);
+    EXPECT_THROW(app.getCommand("build"), std::invalid_argument);
+}
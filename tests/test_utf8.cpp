@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "cli-cmd.hpp"
+
+using namespace cli;
+
+static int dummy_handler(const Actual*) { return 0; }
+
+TEST(Utf8Test, ValidSequences) {
+    EXPECT_TRUE(isValidUtf8(""));
+    EXPECT_TRUE(isValidUtf8("plain ascii text, longer than one sixteen byte block"));
+    EXPECT_TRUE(isValidUtf8("zażółć gęślą jaźń"));
+    EXPECT_TRUE(isValidUtf8("日本語のファイル名.txt"));
+    EXPECT_TRUE(isValidUtf8("\xF0\x9F\x98\x80")); // U+1F600
+    EXPECT_TRUE(isValidUtf8("\xF4\x8F\xBF\xBF")); // U+10FFFF
+}
+
+TEST(Utf8Test, MalformedSequences) {
+    EXPECT_EQ(findInvalidUtf8("\x80", 1), 0u);                       // lone continuation
+    EXPECT_EQ(findInvalidUtf8("abc\xC0\xAF", 5), 3u);                 // overlong '/'
+    EXPECT_EQ(findInvalidUtf8("\xE0\x80\xAF", 3), 0u);                // overlong 3 bytes
+    EXPECT_EQ(findInvalidUtf8("\xED\xA0\x80", 3), 0u);                // surrogate
+    EXPECT_EQ(findInvalidUtf8("\xF4\x90\x80\x80", 4), 0u);            // above U+10FFFF
+    EXPECT_EQ(findInvalidUtf8("\xF5\x80\x80\x80", 4), 0u);
+    EXPECT_EQ(findInvalidUtf8("ok\xC5", 3), 2u);                      // truncated
+    std::string longAscii(40, 'a');
+    EXPECT_EQ(findInvalidUtf8((longAscii + "\xFF").data(), 41), 40u); // after vectorized blocks
+}
+
+TEST(Utf8Test, UnicodeIdentifier) {
+    EXPECT_TRUE(isUnicodeIdentifier("clone"));
+    EXPECT_TRUE(isUnicodeIdentifier("zażółć"));
+    EXPECT_TRUE(isUnicodeIdentifier("ścieżka-2"));
+    EXPECT_TRUE(isUnicodeIdentifier("日本語"));
+    EXPECT_FALSE(isUnicodeIdentifier("2ścieżka"));
+    EXPECT_FALSE(isUnicodeIdentifier("ścieżka-"));
+    EXPECT_FALSE(isUnicodeIdentifier("«quoted»"));
+    EXPECT_FALSE(isUnicodeIdentifier("a\xE2\x80\x94" "b")); // em dash
+    EXPECT_TRUE(isUnicodeIdentifier("Ελληνικά"));
+    EXPECT_TRUE(isUnicodeIdentifier("हिन्दी")); // vowel signs and virama are marks
+    EXPECT_FALSE(isUnicodeIdentifier("\xCC\x81" "a")); // starts with combining acute accent
+    EXPECT_FALSE(isUnicodeIdentifier("a\xE2\x86\x92" "b")); // arrow, symbol
+    EXPECT_FALSE(isUnicodeIdentifier("\xF0\x9F\x98\x80")); // emoji
+    EXPECT_FALSE(isUnicodeIdentifier("a\xE2\x82\xAC")); // euro sign
+    EXPECT_FALSE(isUnicodeIdentifier("a\xD9\xA3")); // Arabic-Indic digit three
+    EXPECT_FALSE(isUnicodeIdentifier("\xEF\xB7\x90")); // noncharacter U+FDD0
+    EXPECT_EQ(classifyToken("zażółć", 1), ArgType::Freeform);
+    EXPECT_EQ(classifyToken("zażółć", 1, true), ArgType::BareIdentifier);
+}
+
+TEST(Utf8Test, RejectsMalformedArgument) {
+    Application app("test", 1, 1, 1);
+    app.addCommand("build")
+        .addArgs("files", "path", 0)
+        .handler(dummy_handler);
+    app.parse({"test", "build", "plik-źródłowy.cpp"});
+    EXPECT_EQ(0, app.currentCommand->errNumber);
+    app.parse({"test", "build", "a.cpp", "plik\xB3.cpp"});
+    EXPECT_EQ(ErrorCode::InvalidUtf8, app.currentCommand->errNumber);
+
+    app.checkUtf8 = 0;
+    app.parse({"test", "build", "a.cpp", "plik\xB3.cpp"});
+    EXPECT_EQ(0, app.currentCommand->errNumber);
+}
+
+TEST(Utf8Test, UnicodeCommandsAndValues) {
+    Application app("test", 1, 1, 1);
+    app.unicodeIdentifiers = 1;
+    app.addCommand("sklonuj")
+        .addArg("gałąź", "unicode-identifier")
+        .handler(dummy_handler);
+    app.parse("test sklonuj główna");
+    EXPECT_EQ(0, app.currentCommand->errNumber);
+    app.parse("test sklonuj ./główna");
+    EXPECT_EQ(ErrorCode::IsNotExpectedTypeArg, app.currentCommand->errNumber);
+}
+
+TEST(Utf8Test, AsciiCommandsByDefault) {
+    Application app("test", 1, 1, 1);
+    EXPECT_THROW(app.addCommand("sklonuj-gałąź"), std::invalid_argument);
+}
@@ -0,0 +1,316 @@
+/*
+ * clicmd-gen: generates C++ tables from schema in JSON, as emitted by Application::schemaAsJson()
+ *
+ *     clicmd-gen schema.json schema.cpp schema.h [--namespace name]
+ *
+ * Output has constexpr StaticSchema (names are checked by compiler), perfect hash
+ * of command names and pre-rendered help. Optional "handler" key of command gives name
+ * of function `int handler(const cli::Actual*)` to be linked.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "static-schema.h"
+
+using nlohmann::json;
+
+namespace
+{
+    std::string literal(const std::string& s) {
+        std::string result = "\"";
+        for (char c : s) {
+            switch (c) {
+                case '"':  result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\t': result += "\\t"; break;
+                default:   result += c;
+            }
+        }
+        return result + "\"";
+    }
+
+    std::string str(const json& j, const char* key) {
+        auto it = j.find(key);
+        return it == j.end() ? "" : it->get<std::string>();
+    }
+
+    const json& list(const json& j, const char* key) {
+        static const json empty = json::array();
+        auto it = j.find(key);
+        return it == j.end() ? empty : *it;
+    }
+
+    std::string padded(const std::string& name, const std::string& desc) {
+        return "   " + name + std::string(std::max(1, 10 - static_cast<int>(name.size())), ' ') + desc;
+    }
+
+    struct HashTables {
+        std::vector<uint32_t> seeds;
+        std::vector<int32_t> slots;
+    };
+
+    /* hash and displace: largest buckets first, each bucket searches seed mapping it to free slots */
+    HashTables buildPerfectHash(const std::vector<std::string>& keys) {
+        size_t n = std::max<size_t>(keys.size(), 1);
+        for (size_t slotCount = n + n / 4 + 1; ; slotCount *= 2) {
+            HashTables t;
+            t.seeds.assign(n / 2 + 1, 0);
+            t.slots.assign(slotCount, -1);
+            std::vector<std::vector<size_t>> buckets(t.seeds.size());
+            for (size_t i = 0; i < keys.size(); i++)
+                buckets[cli::schemaHash(keys[i], 0) % buckets.size()].push_back(i);
+            std::vector<size_t> order(buckets.size());
+            for (size_t i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::stable_sort(order.begin(), order.end(),
+                [&buckets](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+            bool ok = true;
+            for (size_t b : order) {
+                if (buckets[b].empty())
+                    break;
+                bool placed = false;
+                for (uint32_t seed = 1; seed < (1u << 20) && !placed; seed++) {
+                    std::vector<size_t> taken;
+                    for (size_t key : buckets[b]) {
+                        size_t slot = cli::schemaHash(keys[key], seed) % slotCount;
+                        if (t.slots[slot] != -1 || std::find(taken.begin(), taken.end(), slot) != taken.end())
+                            break;
+                        taken.push_back(slot);
+                    }
+                    if (taken.size() != buckets[b].size())
+                        continue;
+                    for (size_t k = 0; k < taken.size(); k++)
+                        t.slots[taken[k]] = static_cast<int32_t>(buckets[b][k]);
+                    t.seeds[b] = seed;
+                    placed = true;
+                }
+                if (!placed) {
+                    ok = false;
+                    break;
+                }
+            }
+            if (ok)
+                return t;
+        }
+    }
+
+    template<typename T>
+    std::string joinNumbers(const std::vector<T>& values) {
+        std::ostringstream os;
+        for (size_t i = 0; i < values.size(); i++)
+            os << (i % 16 ? " " : "\n            ") << values[i] << ",";
+        return os.str();
+    }
+
+    /* static tables have no place for these features, dropping them would change the schema */
+    void checkSupported(const json& j, std::initializer_list<const char*> keys, const std::string& owner) {
+        for (const char* key : keys)
+            if (j.contains(key))
+                throw std::runtime_error(std::string("'") + key + "' can't be generated for " + owner);
+    }
+
+    std::string optionEntry(const json& opt, bool isFlag) {
+        std::string name = str(opt, "name");
+        checkSupported(opt, {"repeatable", "keyValue", "separated"}, name);
+        std::string shorthand = str(opt, "shorthand");
+        std::string desc = str(opt, "desc");
+        if (isFlag)
+            return "cli::flag(" + literal(name) + ", " + literal(shorthand) + ", " + literal(desc) + ")";
+        std::string mode = str(opt, "parameterMode");
+        std::string args = literal(name) + ", " + literal(shorthand) + ", " + literal(desc) + ", "
+                + literal(str(opt, "expectType"));
+        if (mode == "Required")
+            return "cli::reqParameter(" + args + ")";
+        if (mode == "Defaulted")
+            return "cli::defParameter(" + args + ", " + literal(str(opt, "defValue")) + ")";
+        if (mode == "Optional")
+            return "cli::parameter(" + args + ")";
+        throw std::runtime_error("parameter mode '" + mode + "' can't be generated for " + name);
+    }
+
+    /* help of command with merged global options, as Application::commandHelp prints it */
+    std::string commandHelp(const json& cmd, const json& global) {
+        std::map<std::string, std::string> options;
+        for (const json* formal : {&global, &cmd.at("formal")})
+            for (const char* kind : {"flags", "parameters"})
+                for (const auto& opt : list(*formal, kind))
+                    if (!str(opt, "desc").empty() || !options.count(str(opt, "name")))
+                        options[str(opt, "name")] = str(opt, "desc");
+        std::string text = padded(str(cmd, "name"), str(cmd, "desc")) + "\n";
+        for (const auto& [name, desc] : options)
+            text += padded(name, desc) + "\n";
+        return text;
+    }
+
+    void generate(const json& schema, const std::string& ns, const std::string& headerName,
+                  std::ostream& cpp, std::ostream& h) {
+        const json& schemaCommands = list(schema, "commands");
+        if (schemaCommands.empty())
+            throw std::runtime_error("schema has no commands");
+        std::vector<json> commands(schemaCommands.begin(), schemaCommands.end());
+        std::sort(commands.begin(), commands.end(), [](const json& a, const json& b) {
+            return str(a, "name") < str(b, "name");
+        });
+        std::vector<std::string> names;
+        for (const auto& cmd : commands)
+            names.push_back(str(cmd, "name"));
+        static const json noGlobal = json::object();
+        const json& global = schema.contains("global") ? schema.at("global") : noGlobal;
+        checkSupported(schema, {"categories", "helpCategories"}, "schema");
+        checkSupported(global, {"prefixParameters"}, "global options");
+        for (const auto& cmd : commands) {
+            checkSupported(cmd, {"hidden", "argsFrom", "commands"}, str(cmd, "name"));
+            checkSupported(cmd.at("formal"), {"prefixParameters"}, str(cmd, "name"));
+        }
+        bool combineOpts = schema.value("combineOpts", 1) != 0;
+
+        h << "// generated by clicmd-gen, do not edit\n"
+          << "#pragma once\n"
+          << "#include <string_view>\n"
+          << "#ifdef CLICMD_HEADER_ONLY\n"
+          << "#include \"cli-cmd.hpp\"\n"
+          << "#else\n"
+          << "#include \"cli-cmd.h\"\n"
+          << "#endif\n"
+          << "#include \"static-schema.h\"\n\n";
+        for (const auto& cmd : commands)
+            if (!str(cmd, "handler").empty())
+                h << "int " << str(cmd, "handler") << "(const cli::Actual* actual);\n";
+        h << "\nnamespace " << ns << "\n{\n"
+          << "    const cli::StaticCommand* findCommand(std::string_view name);\n"
+          << "    const char* commandHelp(std::string_view name);\n"
+          << "    extern const char* const helpText;\n"
+          << "    void addCommands(cli::Application& app);\n"
+          << "}\n";
+
+        cpp << "// generated by clicmd-gen, do not edit\n"
+            << "#include \"" << headerName << "\"\n\n"
+            << "namespace " << ns << "\n{\n"
+            << "    namespace\n    {\n";
+        std::vector<std::string> entries;
+        for (size_t i = 0; i < commands.size(); i++) {
+            const auto& cmd = commands[i];
+            const json& formal = cmd.at("formal");
+            std::vector<std::string> options, arguments;
+            for (const auto& f : list(formal, "flags"))
+                options.push_back(optionEntry(f, true));
+            for (const auto& p : list(formal, "parameters"))
+                options.push_back(optionEntry(p, false));
+            for (const auto& a : list(formal, "arguments"))
+                arguments.push_back("cli::arg(" + literal(str(a, "name")) + ", " + literal(str(a, "expectType")) + ")");
+            if (formal.contains("varargs")) {
+                const json& va = formal.at("varargs");
+                auto maxN = va.at("max-n").get<uint64_t>();
+                arguments.push_back("cli::args(" + literal(str(va, "name")) + ", " + literal(str(va, "expectType"))
+                        + ", " + std::to_string(va.at("min-n").get<uint64_t>())
+                        + (maxN == std::numeric_limits<size_t>::max() ? "" : ", " + std::to_string(maxN)) + ")");
+            }
+            std::string entry = "cli::command(" + literal(names[i]) + ", " + literal(str(cmd, "desc"));
+            auto emitTable = [&](const char* type, const char* prefix, const std::vector<std::string>& rows) {
+                if (rows.empty())
+                    return;
+                cpp << "        constexpr cli::" << type << " " << prefix << i << "[] = {\n";
+                for (const auto& row : rows)
+                    cpp << "            " << row << ",\n";
+                cpp << "        };\n";
+                entry += std::string(", ") + prefix + std::to_string(i);
+            };
+            emitTable("StaticOption", "options", options);
+            emitTable("StaticArgument", "arguments", arguments);
+            if (!str(cmd, "handler").empty())
+                entry += ", ::" + str(cmd, "handler");
+            entries.push_back(entry + ")");
+        }
+        cpp << "\n        constexpr cli::StaticCommand commands[] = {\n";
+        for (const auto& entry : entries)
+            cpp << "            " << entry << ",\n";
+        cpp << "        };\n\n"
+            << "        constexpr cli::StaticSchema schema(commands, " << (combineOpts ? "true" : "false") << ");\n\n";
+
+        HashTables tables = buildPerfectHash(names);
+        cpp << "        constexpr uint32_t hashSeeds[] = {" << joinNumbers(tables.seeds) << "\n        };\n"
+            << "        constexpr int32_t hashSlots[] = {" << joinNumbers(tables.slots) << "\n        };\n"
+            << "        constexpr cli::StaticHashIndex hashIndex{hashSeeds, " << tables.seeds.size()
+            << ", hashSlots, " << tables.slots.size() << "};\n\n"
+            << "        constexpr bool checkHashIndex() {\n"
+            << "            for (const auto& cmd : schema)\n"
+            << "                if (hashIndex.find(cmd.name, schema.begin()) != &cmd)\n"
+            << "                    return false;\n"
+            << "            return true;\n"
+            << "        }\n"
+            << "        static_assert(checkHashIndex(), \"perfect hash must find every command\");\n\n"
+            << "        constexpr const char* commandHelpTexts[] = {\n";
+        for (const auto& cmd : commands)
+            cpp << "            " << literal(commandHelp(cmd, global)) << ",\n";
+        cpp << "        };\n"
+            << "    }\n\n";
+
+        std::string help;
+        for (const auto& cmd : commands)
+            help += padded(str(cmd, "name"), str(cmd, "desc")) + "\n";
+        cpp << "    const char* const helpText = " << literal(help) << ";\n\n"
+            << "    const cli::StaticCommand* findCommand(std::string_view name) {\n"
+            << "        return hashIndex.find(name, schema.begin());\n"
+            << "    }\n\n"
+            << "    const char* commandHelp(std::string_view name) {\n"
+            << "        auto cmd = findCommand(name);\n"
+            << "        return cmd ? commandHelpTexts[cmd - schema.begin()] : nullptr;\n"
+            << "    }\n\n"
+            << "    void addCommands(cli::Application& app) {\n";
+        for (const auto& f : list(global, "flags"))
+            cpp << "        app.addFlag(" << literal(str(f, "name")) << ", " << literal(str(f, "shorthand")) << ", "
+                << literal(str(f, "desc")) << ");\n";
+        for (const auto& p : list(global, "parameters")) {
+            checkSupported(p, {"repeatable", "keyValue", "separated"}, str(p, "name"));
+            std::string mode = str(p, "parameterMode");
+            std::string args = literal(str(p, "name")) + ", " + literal(str(p, "shorthand")) + ", "
+                    + literal(str(p, "desc")) + ", " + literal(str(p, "expectType"));
+            if (mode == "Required")
+                cpp << "        app.addReqParameter(" << args << ");\n";
+            else if (mode == "Defaulted")
+                cpp << "        app.addDefParameter(" << args << ", " << literal(str(p, "defValue")) << ");\n";
+            else
+                cpp << "        app.addParameter(" << args << ");\n";
+        }
+        cpp << "        app.addCommands(schema);\n"
+            << "    }\n"
+            << "}\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    std::string ns = "generated";
+    auto it = std::find(args.begin(), args.end(), "--namespace");
+    if (it != args.end() && it + 1 != args.end()) {
+        ns = *(it + 1);
+        args.erase(it, it + 2);
+    }
+    if (args.size() != 3) {
+        std::cerr << "usage: clicmd-gen schema.json out.cpp out.h [--namespace name]" << std::endl;
+        return 2;
+    }
+    try {
+        std::ifstream in(args[0]);
+        if (!in)
+            throw std::runtime_error("can't open " + args[0]);
+        json schema = json::parse(in);
+        std::ostringstream cpp, h;
+        std::string headerName = args[2].substr(args[2].find_last_of("/\\") + 1);
+        generate(schema, ns, headerName, cpp, h);
+        std::ofstream(args[1]) << cpp.str();
+        std::ofstream(args[2]) << h.str();
+    } catch (const std::exception& e) {
+        std::cerr << "clicmd-gen: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}